@@ -0,0 +1,105 @@
+// Per-commit cost of each save durability mode.
+//
+//   commit_benchmark [--tasks N] [--commits K] [--dir PATH]
+//
+// Writes a task file of N tasks K times in each mode and prints the latency of a single commit.
+// "in-place" is the old truncate-and-write save for comparison. Run it on the filesystem that
+// holds tasks.dat; results on tmpfs say nothing about fsync.
+#include "../include/atomic_writer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+static std::string makeTaskFile(int tasks) {
+    std::string buffer;
+    for (int id = 1; id <= tasks; id++) {
+        char line[96];
+        int length = std::snprintf(line, sizeof(line), "%d|Benchmark task number %d|2026-%02d-%02d 09:30|%d\n",
+                                   id, id, id % 12 + 1, id % 28 + 1, id % 3 == 0);
+        buffer.append(line, static_cast<size_t>(length));
+    }
+    return buffer;
+}
+
+static void report(const std::string& mode, std::vector<double> micros, double drainMicros) {
+    std::sort(micros.begin(), micros.end());
+    double total = 0;
+    for (double sample : micros) total += sample;
+    auto at = [&micros](double fraction) {
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(micros.size() - 1));
+        return micros[index];
+    };
+    std::cout << std::left << std::setw(14) << mode << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << total / static_cast<double>(micros.size())
+              << std::setw(12) << at(0.5)
+              << std::setw(12) << at(0.99)
+              << std::setw(12) << micros.back();
+    if (drainMicros >= 0) {
+        std::cout << "   (final group sync " << drainMicros << " us)";
+    }
+    std::cout << "\n";
+}
+
+static std::vector<double> run(int commits, const std::function<void()>& commit) {
+    std::vector<double> micros;
+    micros.reserve(static_cast<size_t>(commits));
+    for (int i = 0; i < commits; i++) {
+        auto start = Clock::now();
+        commit();
+        micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    return micros;
+}
+
+int main(int argc, char* argv[]) {
+    int tasks = 1000;
+    int commits = 200;
+    std::string directory = fs::temp_directory_path().string();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--tasks") == 0) tasks = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--commits") == 0) commits = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--dir") == 0) directory = argv[i + 1];
+    }
+
+    std::string contents = makeTaskFile(tasks);
+    std::string path = (fs::path(directory) / "commit_benchmark.dat").string();
+    std::cout << commits << " commits of " << tasks << " tasks (" << contents.size() / 1024 << " KiB) in " << directory << "\n\n";
+    std::cout << std::left << std::setw(14) << "mode" << std::right
+              << std::setw(12) << "mean us" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "max us" << "\n";
+
+    report("in-place", run(commits, [&] {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }), -1);
+
+    const std::pair<AtomicWriter::Durability, const char*> modes[] = {
+        {AtomicWriter::Durability::OS, "OS"},
+        {AtomicWriter::Durability::GROUP, "GROUP 100ms"},
+        {AtomicWriter::Durability::SYNC, "SYNC"}
+    };
+    for (const auto& [durability, name] : modes) {
+        AtomicWriter::setPolicy(durability, std::chrono::milliseconds(100));
+        std::vector<double> micros = run(commits, [&] { AtomicWriter::commit(path, contents); });
+        double drain = -1;
+        if (durability == AtomicWriter::Durability::GROUP) {
+            auto start = Clock::now();
+            AtomicWriter::flush();
+            drain = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        }
+        report(name, micros, drain);
+    }
+
+    fs::remove(path);
+    return 0;
+}
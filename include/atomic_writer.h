@@ -0,0 +1,36 @@
+#ifndef ATOMIC_WRITER_H
+#define ATOMIC_WRITER_H
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+// Crash-safe file replacement. Every commit writes the new contents to "<path>.tmp" and renames
+// it over the old file, so readers see either the old or the new version, never a torn one.
+// The durability policy decides when the data is forced to disk with fsync:
+//   SYNC  - the file and its directory are synced before commit returns
+//   GROUP - the file is synced before the rename, but commit returns without syncing its
+//           directory; a background thread syncs the directories of everything committed in
+//           the last interval at once, so a power failure can undo that interval's renames
+//           but never leaves a file torn or empty
+//   OS    - never synced explicitly; the kernel writes back when it likes
+class AtomicWriter {
+public:
+    enum class Durability {
+        SYNC,
+        GROUP,
+        OS
+    };
+
+    static void setPolicy(Durability durability, std::chrono::milliseconds groupInterval);
+    static Durability getDurability();
+    // Accepts "SYNC", "GROUP" and "OS"
+    static bool parseDurability(const std::string& name, Durability& durability);
+    static const char* durabilityName(Durability durability);
+
+    static bool commit(const std::string& path, std::string_view contents);
+    // Syncs anything a group commit still holds; called before exit
+    static void flush();
+};
+
+#endif
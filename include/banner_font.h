@@ -0,0 +1,136 @@
+#ifndef BANNER_FONT_H
+#define BANNER_FONT_H
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+// Block-letter font used for the month and year banner above the calendar
+namespace BannerFont {
+
+constexpr int GLYPH_HEIGHT = 6;
+
+struct Glyph {
+    std::array<std::string_view, GLYPH_HEIGHT> rows;
+};
+
+// Every character in the font occupies one terminal column, so the width is the code point count
+constexpr int columns(std::string_view text) {
+    int count = 0;
+    for (char c : text) {
+        if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) count++;
+    }
+    return count;
+}
+
+constexpr Glyph DIGITS[10] = {
+    {{" ██████╗ ", "██╔═══██╗", "██║   ██║", "██║   ██║", "╚██████╔╝", " ╚═════╝ "}},
+    {{" ██╗", "███║", "╚██║", " ██║", " ██║", " ╚═╝"}},
+    {{"██████╗ ", "╚════██╗", " █████╔╝", "██╔═══╝ ", "███████╗", "╚══════╝"}},
+    {{"██████╗ ", "╚════██╗", " █████╔╝", " ╚═══██╗", "██████╔╝", "╚═════╝ "}},
+    {{"██╗  ██╗", "██║  ██║", "███████║", "╚════██║", "     ██║", "     ╚═╝"}},
+    {{"███████╗", "██╔════╝", "███████╗", "╚════██║", "███████║", "╚══════╝"}},
+    {{" ██████╗ ", "██╔════╝ ", "███████╗ ", "██╔═══██╗", "╚██████╔╝", " ╚═════╝ "}},
+    {{"███████╗", "╚════██║", "    ██╔╝", "   ██╔╝ ", "   ██║  ", "   ╚═╝  "}},
+    {{" █████╗ ", "██╔══██╗", "╚█████╔╝", "██╔══██╗", "╚█████╔╝", " ╚════╝ "}},
+    {{" █████╗ ", "██╔══██╗", "╚██████║", " ╚═══██║", " █████╔╝", " ╚════╝ "}}
+};
+
+// Month names are a closed set, so each abbreviation is stored as one pre-kerned glyph
+constexpr Glyph MONTHS[12] = {
+    {{"     ██╗ █████╗ ███╗   ██╗",
+      "     ██║██╔══██╗████╗  ██║",
+      "     ██║███████║██╔██╗ ██║",
+      "██   ██║██╔══██║██║╚██╗██║",
+      "╚█████╔╝██║  ██║██║ ╚████║",
+      " ╚════╝ ╚═╝  ╚═╝╚═╝  ╚═══╝"}},
+    {{" ███████╗███████╗██████╗ ",
+      " ██╔════╝██╔════╝██╔══██╗",
+      " █████╗  █████╗  ██████╔╝",
+      " ██╔══╝  ██╔══╝  ██╔══██╗",
+      " ██║     ███████╗██████╔╝",
+      " ╚═╝     ╚══════╝╚═════╝ "}},
+    {{" ███╗   ███╗ █████╗ ██████╗ ",
+      " ████╗ ████║██╔══██╗██╔══██╗",
+      " ██╔████╔██║███████║██████╔╝",
+      " ██║╚██╔╝██║██╔══██║██╔══██╗",
+      " ██║ ╚═╝ ██║██║  ██║██║  ██║",
+      " ╚═╝     ╚═╝╚═╝  ╚═╝╚═╝  ╚═╝"}},
+    {{"  █████╗ ██████╗ ██████╗ ",
+      " ██╔══██╗██╔══██╗██╔══██╗",
+      " ███████║██████╔╝██████╔╝",
+      " ██╔══██║██╔═══╝ ██╔══██╗",
+      " ██║  ██║██║     ██║  ██║",
+      " ╚═╝  ╚═╝╚═╝     ╚═╝  ╚═╝"}},
+    {{" ███╗   ███╗ █████╗ ██╗   ██╗",
+      " ████╗ ████║██╔══██╗╚██╗ ██╔╝",
+      " ██╔████╔██║███████║ ╚████╔╝ ",
+      " ██║╚██╔╝██║██╔══██║  ╚██╔╝  ",
+      " ██║ ╚═╝ ██║██║  ██║   ██║   ",
+      " ╚═╝     ╚═╝╚═╝  ╚═╝   ╚═╝   "}},
+    {{"     ██╗██╗   ██╗███╗   ██╗",
+      "     ██║██║   ██║████╗  ██║",
+      "     ██║██║   ██║██╔██╗ ██║",
+      "██   ██║██║   ██║██║╚██╗██║",
+      "╚█████╔╝╚██████╔╝██║ ╚████║",
+      " ╚════╝  ╚═════╝ ╚═╝  ╚═══╝"}},
+    {{"     ██╗██╗   ██╗██╗     ",
+      "     ██║██║   ██║██║     ",
+      "     ██║██║   ██║██║     ",
+      "██   ██║██║   ██║██║     ",
+      "╚█████╔╝╚██████╔╝███████╗",
+      " ╚════╝  ╚═════╝ ╚══════╝"}},
+    {{"  █████╗ ██╗   ██╗ ██████╗ ",
+      " ██╔══██╗██║   ██║██╔════╝ ",
+      " ███████║██║   ██║██║  ███╗",
+      " ██╔══██║██║   ██║██║   ██║",
+      " ██║  ██║╚██████╔╝╚██████╔╝",
+      " ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ "}},
+    {{"███████╗███████╗██████╗ ████████╗",
+      "██╔════╝██╔════╝██╔══██╗╚══██╔══╝",
+      "███████╗█████╗  ██████╔╝   ██║   ",
+      "╚════██║██╔══╝  ██╔═══╝    ██║   ",
+      "███████║███████╗██║        ██║   ",
+      "╚══════╝╚══════╝╚═╝        ╚═╝   "}},
+    {{"  ██████╗  ██████╗████████╗",
+      " ██╔═══██╗██╔════╝╚══██╔══╝",
+      " ██║   ██║██║        ██║   ",
+      " ██║   ██║██║        ██║   ",
+      " ╚██████╔╝╚██████╗   ██║   ",
+      "  ╚═════╝  ╚═════╝   ╚═╝   "}},
+    {{" ███╗   ██╗ ██████╗ ██╗   ██╗",
+      " ████╗  ██║██╔═══██╗██║   ██║",
+      " ██╔██╗ ██║██║   ██║██║   ██║",
+      " ██║╚██╗██║██║   ██║╚██╗ ██╔╝",
+      " ██║ ╚████║╚██████╔╝ ╚████╔╝ ",
+      " ╚═╝  ╚═══╝ ╚═════╝   ╚═══╝  "}},
+    {{" ██████╗ ███████╗ ██████╗ ",
+      " ██╔══██╗██╔════╝██╔════╝ ",
+      " ██║  ██║█████╗  ██║      ",
+      " ██║  ██║██╔══╝  ██║      ",
+      " ██████╔╝███████╗╚██████╗ ",
+      " ╚═════╝ ╚══════╝ ╚═════╝ "}}
+};
+
+constexpr int width(const Glyph& glyph) {
+    return columns(glyph.rows[0]);
+}
+
+template <size_t N>
+constexpr std::array<int, N> widths(const Glyph (&glyphs)[N]) {
+    std::array<int, N> result{};
+    for (size_t i = 0; i < N; i++) {
+        result[i] = width(glyphs[i]);
+    }
+    return result;
+}
+
+constexpr std::array<int, 10> DIGIT_WIDTHS = widths(DIGITS);
+constexpr std::array<int, 12> MONTH_WIDTHS = widths(MONTHS);
+
+static_assert(DIGIT_WIDTHS[0] == 9 && DIGIT_WIDTHS[1] == 4 && DIGIT_WIDTHS[2] == 8, "digit glyph widths");
+static_assert(MONTH_WIDTHS[8] == 33, "month glyph widths");
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef CALENDAR_LAYOUT_H
+#define CALENDAR_LAYOUT_H
+
+#include <cstddef>
+#include <string>
+
+// Geometry of the month grid and the padding runs it is drawn with. The configured cell size is
+// an upper bound: on a terminal the cells shrink to fit its size, down to the minimums. The
+// layout is cached and only worked out again after SIGWINCH or a change of the bounds.
+class CalendarLayout {
+public:
+    static const int MIN_CELL_WIDTH = 13;
+    static const int MAX_CELL_WIDTH = 40;
+    static const int MIN_CELL_HEIGHT = 5;
+    static const int MAX_CELL_HEIGHT = 10;
+
+    int cellWidth = 0;
+    int cellHeight = 0;
+    // Lines the whole calendar takes with six weeks, banner and weekday names included
+    int height = 0;
+    // Event lines a cell shows below the day number
+    int eventRows = 0;
+    // Columns left for a task description after the pin and the cell's right margin
+    size_t descriptionColumns = 0;
+    // cellWidth - 1 spaces and border characters, and the gap after a two-letter weekday name
+    std::string blankCell;
+    std::string cellRule;
+    std::string weekdayGap;
+
+    // Layout for a terminal of the given size; a size of 0 (not a terminal) keeps the bounds
+    static CalendarLayout compute(int columns, int rows, int maxCellWidth, int maxCellHeight);
+    // The layout for the terminal behind stdout
+    static const CalendarLayout& current(int maxCellWidth, int maxCellHeight);
+    // Marks the cached layout stale; safe to call from a signal handler
+    static void invalidate();
+    // Invalidates the layout on every SIGWINCH for the rest of the process; does nothing on Windows
+    static void watchResize();
+};
+
+#endif
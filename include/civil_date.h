@@ -0,0 +1,89 @@
+#ifndef CIVIL_DATE_H
+#define CIVIL_DATE_H
+
+#include <cstdint>
+
+// Proleptic Gregorian calendar arithmetic on day counts since 1970-01-01 (H. Hinnant's
+// days_from_civil / civil_from_days). Everything is constexpr and correct for any year, so
+// building a month grid needs no libc time calls.
+namespace CivilDate {
+
+struct Date {
+    int year;
+    int month;
+    int day;
+};
+
+// Rounds toward negative infinity, unlike '/'
+constexpr int64_t floorDiv(int64_t value, int64_t divisor) {
+    return value / divisor - (value % divisor < 0 ? 1 : 0);
+}
+
+constexpr bool isLeapYear(int64_t year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+constexpr int daysInMonth(int64_t year, int month) {
+    return month == 2 ? (isLeapYear(year) ? 29 : 28) : month == 4 || month == 6 || month == 9 || month == 11 ? 30 : 31;
+}
+
+// Days since 1970-01-01
+constexpr int64_t daysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = floorDiv(year, 400);
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+constexpr Date civilFromDays(int64_t days) {
+    days += 719468;
+    int64_t era = floorDiv(days, 146097);
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t shifted = (5 * dayOfYear + 2) / 153;
+    int month = static_cast<int>(shifted < 10 ? shifted + 3 : shifted - 9);
+    return {static_cast<int>(yearOfEra + era * 400 + (month <= 2)), month, static_cast<int>(dayOfYear - (153 * shifted + 2) / 5 + 1)};
+}
+
+// 0 is Sunday; 1970-01-01 was a Thursday
+constexpr int weekday(int64_t days) {
+    return static_cast<int>(days + 4 - floorDiv(days + 4, 7) * 7);
+}
+
+// A month of a particular year; stepping past December or before January carries into the year
+struct YearMonth {
+    int year;
+    int month;
+
+    constexpr YearMonth plus(int months) const {
+        int64_t index = static_cast<int64_t>(year) * 12 + (month - 1) + months;
+        return {static_cast<int>(floorDiv(index, 12)), static_cast<int>(index - floorDiv(index, 12) * 12) + 1};
+    }
+    constexpr int days() const {
+        return daysInMonth(year, month);
+    }
+    // Weekday of the 1st, 0 for Sunday
+    constexpr int firstWeekday() const {
+        return weekday(daysFromCivil(year, month, 1));
+    }
+    constexpr bool operator==(const YearMonth& other) const {
+        return year == other.year && month == other.month;
+    }
+    constexpr bool operator!=(const YearMonth& other) const {
+        return !(*this == other);
+    }
+};
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "leap century");
+static_assert(civilFromDays(-1).year == 1969 && civilFromDays(-1).day == 31, "before the epoch");
+static_assert(weekday(daysFromCivil(2024, 2, 29)) == 4, "2024-02-29 was a Thursday");
+static_assert(YearMonth{2026, 12}.plus(1) == YearMonth{2027, 1} && YearMonth{2026, 1}.plus(-1) == YearMonth{2025, 12}, "year carry");
+static_assert(YearMonth{2100, 2}.days() == 28 && YearMonth{2400, 2}.days() == 29, "century leap years");
+
+}
+
+#endif
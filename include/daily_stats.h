@@ -0,0 +1,50 @@
+#ifndef DAILY_STATS_H
+#define DAILY_STATS_H
+
+#include <cstdint>
+#include <vector>
+
+// Task counts for every day over a contiguous range of days, with prefix sums so totals over any
+// date range (or over one weekday of it) take O(1). Counts are updated in place as tasks change;
+// the prefix sums are rebuilt in O(days) on the first query after a change. Days are counted
+// from 1970-01-01; tasks outside FIRST_DAY..LAST_DAY are left out.
+class DailyStats {
+public:
+    // 1900-01-01 and 2200-12-31
+    static const int64_t FIRST_DAY = -25567;
+    static const int64_t LAST_DAY = 84370;
+
+    struct Totals {
+        int64_t total = 0;
+        int64_t completed = 0;
+        // Sum of the pending tasks' deadlines, in minutes since the epoch (UTC)
+        int64_t pendingMinutes = 0;
+
+        int64_t pending() const { return total - completed; }
+        Totals& operator+=(const Totals& other);
+        Totals operator-(const Totals& other) const;
+    };
+
+    // instant is the task's deadline in minutes since the epoch
+    void add(int64_t day, int totalDelta, int completedDelta, int64_t instant);
+    void clear();
+    // Totals over firstDay..lastDay, both included
+    Totals range(int64_t firstDay, int64_t lastDay) const;
+    // Totals over the days of firstDay..lastDay falling on the weekday (0 is Sunday)
+    Totals weekday(int64_t firstDay, int64_t lastDay, int weekday) const;
+    // First and last day with any task; false when there are none
+    bool span(int64_t& firstDay, int64_t& lastDay) const;
+
+private:
+    // Day of days[0]
+    int64_t base = 0;
+    std::vector<Totals> days;
+    // prefix[i] sums days[0..i); stride[i] is days[i] + stride[i - 7]
+    mutable std::vector<Totals> prefix;
+    mutable std::vector<Totals> stride;
+    mutable bool stale = true;
+
+    void build() const;
+};
+
+#endif
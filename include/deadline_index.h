@@ -0,0 +1,66 @@
+#ifndef DEADLINE_INDEX_H
+#define DEADLINE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+#include "string_arena.h"
+
+// Pending tasks ordered by deadline, and a second ordering by priority then deadline. Entries
+// carry what a "due" listing prints, so the next N deadlines are found with one O(log n) seek
+// and N steps, and the N most important tasks with N steps, without touching the store's rows.
+class DeadlineIndex {
+public:
+    struct Entry {
+        // Deadline in minutes since the epoch (UTC)
+        uint64_t minute;
+        uint8_t calendar;
+        int id;
+        StringRef description;
+        StringRef deadline;
+        StringRef tags;
+        // See TaskStore::Priority; higher comes first
+        uint8_t priority;
+    };
+
+    // The current minute since the epoch, the same scale entries are keyed by
+    static uint64_t now();
+
+    void insert(const Entry& entry);
+    // Removes the entry with the same minute, priority, calendar and id
+    void erase(const Entry& entry);
+    void clear();
+    size_t size() const;
+
+    // Up to count entries due at or after from, earliest first
+    std::vector<Entry> from(uint64_t minute, size_t count) const;
+    // Every entry due before the given minute, earliest first
+    std::vector<Entry> before(uint64_t minute) const;
+    std::vector<Entry> at(uint64_t minute) const;
+    // Earliest key strictly after the given minute, or 0 when nothing is due later
+    uint64_t nextAfter(uint64_t minute) const;
+    // The count highest-priority entries, earliest deadline first within a priority
+    std::vector<Entry> top(size_t count) const;
+
+private:
+    struct Order {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.minute != b.minute) return a.minute < b.minute;
+            if (a.calendar != b.calendar) return a.calendar < b.calendar;
+            return a.id < b.id;
+        }
+    };
+
+    struct PriorityOrder {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.priority != b.priority) return a.priority > b.priority;
+            return Order()(a, b);
+        }
+    };
+
+    std::multiset<Entry, Order> entries;
+    std::multiset<Entry, PriorityOrder> byPriority;
+};
+
+#endif
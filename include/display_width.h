@@ -0,0 +1,25 @@
+#ifndef DISPLAY_WIDTH_H
+#define DISPLAY_WIDTH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Terminal column widths of UTF-8 text, following East Asian Width and emoji presentation
+namespace DisplayWidth {
+
+// Columns taken by a single code point: 0 for combining marks and joiners, 2 for wide and emoji
+int codePointWidth(uint32_t codePoint);
+
+size_t columns(std::string_view text);
+
+// Length in bytes of the longest prefix that fits in maxColumns without splitting a grapheme cluster
+size_t truncate(std::string_view text, size_t maxColumns, size_t* usedColumns = nullptr);
+
+// Truncates text to maxColumns, replacing the tail with "..." when it does not fit
+std::string ellipsize(std::string_view text, size_t textColumns, size_t maxColumns, size_t* usedColumns = nullptr);
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+// The last few rendered calendar frames, least recently used dropped first. A frame is only
+// reused when everything it was drawn from matches, including the store generation, so any
+// change to the tasks makes the old frames unreachable.
+class FrameCache {
+public:
+    static const size_t CAPACITY = 8;
+
+    struct Key {
+        int year;
+        int month;
+        int selectedDay;
+        int cellWidth;
+        int cellHeight;
+        int eventDisplay;
+        int borderBold;
+        int textBold;
+        std::string borderColor;
+        std::string textColor;
+        std::string eventsColor;
+        std::vector<std::string> tags;
+        uint64_t generation;
+
+        bool operator==(const Key& other) const;
+    };
+
+    // The cached frame, moved to the front, or nullptr
+    const std::string* find(const Key& key);
+    void insert(Key key, std::string frame);
+    void clear();
+
+private:
+    std::list<std::pair<Key, std::string>> frames;
+};
+
+#endif
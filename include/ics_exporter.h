@@ -0,0 +1,56 @@
+#ifndef ICS_EXPORTER_H
+#define ICS_EXPORTER_H
+
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CivilTime;
+
+// Writes task.ics and opens it in the calendar app on a background thread. Tasks added in quick
+// succession are collected into a single file and a single app launch.
+class IcsExporter {
+public:
+    // Adds arriving within this window of the previous one join the same export
+    static constexpr std::chrono::milliseconds COALESCE_WINDOW{300};
+    // Upper bound on how long a steady stream of adds can hold back an export
+    static constexpr std::chrono::milliseconds MAX_DELAY{2000};
+
+    IcsExporter() = default;
+    ~IcsExporter();
+    IcsExporter(const IcsExporter&) = delete;
+    IcsExporter& operator=(const IcsExporter&) = delete;
+
+    // zone names the tzdb zone the event is shown in; events without one are written in UTC
+    void enqueue(const std::string& icsPath, const std::string& description, int64_t utcSeconds, const std::string& zone, bool launch);
+    // Exports anything still queued right away and stops the worker
+    void finish();
+
+private:
+    struct Event {
+        std::string description;
+        int64_t utcSeconds;
+        std::string zone;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+    std::vector<Event> pending;
+    std::string path;
+    bool launchPending = false;
+    bool stopping = false;
+    std::chrono::steady_clock::time_point firstQueued;
+    std::chrono::steady_clock::time_point lastQueued;
+
+    void run();
+    static void formatStamp(const CivilTime& time, char* out);
+    static bool writeFile(const std::string& icsPath, const std::vector<Event>& events);
+    static void launch(const std::string& icsPath);
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+// Destination for everything TaskManager renders
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+    virtual void write(const char* data, size_t length) = 0;
+    virtual void flush() {}
+    // Like flush, for output that is one complete screen: a newer frame may replace it if it has
+    // not reached the terminal yet
+    virtual void flushFrame() { flush(); }
+    // Flushes and returns once the output has actually been written, e.g. before another process
+    // or a terminal mode change takes over the terminal
+    virtual void drain() { flush(); }
+    // True when written data is thrown away, so callers can skip formatting entirely
+    virtual bool discards() const { return false; }
+};
+
+// Collects output in memory
+class BufferedSink : public OutputSink {
+public:
+    void write(const char* data, size_t length) override;
+    const std::string& str() const;
+    void clear();
+
+private:
+    std::string buffer;
+};
+
+// Drops all output
+class NullSink : public OutputSink {
+public:
+    void write(const char* data, size_t length) override;
+    bool discards() const override;
+};
+
+// Buffers output and writes it to a file descriptor on flush or when the buffer fills up
+class FdSink : public OutputSink {
+public:
+    explicit FdSink(int fd, size_t capacity = 64 * 1024);
+    ~FdSink() override;
+    void write(const char* data, size_t length) override;
+    void flush() override;
+    // A descriptor that stops accepting writes (e.g. a pager that quit) discards the rest
+    bool discards() const override;
+
+private:
+    int fd;
+    size_t capacity;
+    bool closed;
+    std::string pending;
+};
+
+// FdSink for terminals that may be slow to accept output (e.g. over SSH). Output collects in a
+// front buffer; flush() moves it to the back buffer, which a writer thread drains, so rendering
+// and input handling never wait on the tty. A frame handed over while the previous frame is
+// still waiting in the back buffer replaces it. Descriptors that are not terminals are written
+// in place, which keeps their order with stderr.
+class AsyncFdSink : public OutputSink {
+public:
+    // Largest backlog before write() waits for the terminal to catch up
+    static const size_t MAX_BACKLOG = 4 * 1024 * 1024;
+
+    explicit AsyncFdSink(int fd, size_t capacity = 64 * 1024);
+    ~AsyncFdSink() override;
+    void write(const char* data, size_t length) override;
+    void flush() override;
+    void flushFrame() override;
+    void drain() override;
+    bool discards() const override;
+
+private:
+    int fd;
+    size_t capacity;
+    bool threaded;
+    std::atomic<bool> closed;
+    std::string front;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable idle;
+    std::string back;
+    // Where the frame at the end of back starts, or npos when back ends with ordinary output
+    size_t frameStart;
+    bool writing;
+    bool stopping;
+    std::thread writer;
+
+    void handOver(bool frame);
+    void writeAll(const std::string& data);
+    void run();
+};
+
+// Adapts an OutputSink to std::ostream
+class SinkStreamBuf : public std::streambuf {
+public:
+    explicit SinkStreamBuf(OutputSink* sink);
+    void setSink(OutputSink* sink);
+
+protected:
+    int overflow(int ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    OutputSink* sink;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+class PerfStats {
+public:
+    enum Counter {
+        FILE_OPENS,
+        TERMINAL_BYTES,
+        TASKS_PARSED,
+        TASKS_WRITTEN,
+        ICS_EXPORTS,
+        APP_LAUNCHES,
+        FRAME_CACHE_HITS,
+        FRAMES_DROPPED,
+        COUNTER_COUNT
+    };
+
+    enum Timer {
+        LOAD_TASKS,
+        SAVE_TASKS,
+        SORT_TASKS,
+        CONFIG_READ,
+        CONFIG_WRITE,
+        PROCESS_COMMAND,
+        DISPLAY_CALENDAR,
+        LOAD_ARCHIVE,
+        LOAD_SEGMENT,
+        FSYNC,
+        TIMER_COUNT
+    };
+
+    // Records the elapsed time of the enclosing scope into a latency histogram
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Timer timer);
+        ~ScopedTimer();
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    private:
+        Timer timer;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static void increment(Counter counter, uint64_t amount = 1);
+    static void record(Timer timer, uint64_t nanoseconds);
+    static uint64_t get(Counter counter);
+    static void report(std::ostream& out);
+    static void reset();
+
+private:
+    // Bucket i holds samples in [2^i, 2^(i+1)) nanoseconds
+    static const int BUCKET_COUNT = 40;
+
+    struct Histogram {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> max{0};
+        std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+    };
+
+    static std::atomic<uint64_t> counters[COUNTER_COUNT];
+    static Histogram histograms[TIMER_COUNT];
+    static uint64_t percentile(const Histogram& histogram, double fraction);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef RECORD_WRITER_H
+#define RECORD_WRITER_H
+
+#include <string>
+#include <string_view>
+#include "output_sink.h"
+
+// Machine-readable task records for scripts: no colors and no padding. Records are formatted
+// into one buffer that is handed to the sink in large blocks, so exporting costs about as much
+// as copying the text.
+//   JSONL - one JSON object per line
+//   CSV   - RFC 4180, fields quoted only when they contain a comma, quote or line break
+//   TSV   - tab-separated, with backslash, tab, CR and LF escaped as \\, \t, \r and \n
+class RecordWriter {
+public:
+    enum class Format {
+        JSONL,
+        CSV,
+        TSV
+    };
+
+    // Accepts "jsonl", "csv" and "tsv"
+    static bool parseFormat(std::string_view name, Format& format);
+
+    RecordWriter(OutputSink& sink, Format format);
+    ~RecordWriter();
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    // tags is comma-separated; JSONL writes it as an array. priority is empty for none.
+    void record(int id, std::string_view calendar, std::string_view description, std::string_view deadline,
+                std::string_view tags, std::string_view priority, bool completed);
+    void finish();
+
+private:
+    static const size_t FLUSH_SIZE = 64 * 1024;
+
+    OutputSink& sink;
+    Format format;
+    std::string buffer;
+
+    void field(std::string_view text);
+    void separator();
+};
+
+#endif
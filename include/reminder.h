@@ -0,0 +1,27 @@
+#ifndef REMINDER_H
+#define REMINDER_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include "task_manager.h"
+
+// Announces pending deadlines as they come due. The process sleeps on a single timer armed for
+// the next deadline (a timerfd on Linux, so clock changes re-arm it) while watching stdin, and
+// wakes exactly once per deadline instead of polling. Each announcement rings the terminal bell
+// and, inside a desktop session, sends a desktop notification.
+class Reminder {
+public:
+    explicit Reminder(TaskManager& manager);
+    // Returns once a line is entered, stdin closes, Ctrl-C is pressed or nothing is left to wait for
+    void run();
+
+private:
+    TaskManager& manager;
+
+    // Waits until the deadline passes (true) or input arrives (false)
+    static bool waitUntil(time_t deadline);
+    static void notifyDesktop(const std::string& summary);
+};
+
+#endif
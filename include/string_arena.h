@@ -0,0 +1,43 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Location of a string inside a StringArena: the chunk index is kept in the upper 16 bits of offset
+struct StringRef {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+// Bump allocator for immutable strings. Identical strings are interned so they share one copy.
+class StringArena {
+public:
+    StringArena();
+    StringRef intern(std::string_view text);
+    std::string_view view(StringRef ref) const;
+    void clear();
+
+private:
+    static const uint32_t CHUNK_SIZE = 1 << 16;
+
+    struct Slot {
+        uint32_t hash;
+        StringRef ref;
+        bool used;
+    };
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    uint32_t chunkUsed;
+    std::vector<Slot> slots;
+    size_t slotCount;
+
+    StringRef store(std::string_view text);
+    void grow();
+    static uint32_t hash(std::string_view text);
+};
+
+#endif
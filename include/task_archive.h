@@ -0,0 +1,54 @@
+#ifndef TASK_ARCHIVE_H
+#define TASK_ARCHIVE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Compressed cold storage for old completed tasks. Tasks are grouped into one deflate block per
+// month (in the task file line format), and an index at the end of the file maps each month to
+// its block, so opening the archive reads only the index and single months load on their own.
+class TaskArchive {
+public:
+    struct Block {
+        // Month key, year << 4 | month, matching TaskStore's packed dates shifted right by 5
+        uint32_t month;
+        uint64_t offset;
+        uint32_t compressedSize;
+        uint32_t rawSize;
+        uint32_t taskCount;
+        int32_t maxId;
+    };
+
+    void setPath(const std::string& archivePath);
+    const std::string& getPath() const;
+
+    // Reads the index; a missing file is an empty archive
+    bool open();
+    bool empty() const;
+    size_t taskCount() const;
+    int maxId() const;
+    bool contains(uint32_t month) const;
+    std::vector<uint32_t> months() const;
+
+    // Appends the month's task lines to lines
+    bool readMonth(uint32_t month, std::string& lines) const;
+    // Merges task lines into their months and rewrites the file
+    bool append(const std::map<uint32_t, std::string>& linesByMonth);
+    // Drops the given ids from their months in a single rewrite
+    bool removeTasks(const std::map<uint32_t, std::vector<int>>& idsByMonth);
+    void clear();
+
+private:
+    std::string path;
+    // Sorted by month
+    std::vector<Block> index;
+
+    const Block* find(uint32_t month) const;
+    // Writes a new archive where the given months are replaced by new contents (empty drops the
+    // month) and every other block is copied over still compressed
+    bool rewrite(const std::map<uint32_t, std::string>& replaced);
+};
+
+#endif
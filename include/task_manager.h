@@ -2,33 +2,74 @@
 #define TASK_MANAGER_H
 
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <fstream>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include <set>
+#include <functional>
 #include <vector>
 #include <nlohmann/json.hpp>
+#include "output_sink.h"
+#include "task_store.h"
+#include "task_archive.h"
+#include "task_segments.h"
+#include "record_writer.h"
+#include "time_zone.h"
+#include "civil_date.h"
+#include "frame_cache.h"
+#include "calendar_layout.h"
 
 using json = nlohmann::json;
 
-struct Task {
-    int id;
-    std::string description;
-    std::string deadline;           
-    bool completed;
-    int month;
-    int day;
-    int year;
-};
-
 class TaskManager {
+public:
+    // A task file to load, shown under name when more than one calendar is open
+    struct CalendarSource {
+        std::string name;
+        std::string filename;
+    };
+
 private:
-    std::map<int, std::vector<Task>> tasks;
-    std::vector<Task> taskList;
-    std::string filename;
-    int nextId;
+    // One task file. Tasks of every calendar share the store, which records the owning
+    // calendar of each row; ids are allocated per calendar.
+    struct Calendar {
+        std::string name;
+        std::string filename;
+        // Empty uses EVENTS_COLOR
+        std::string color;
+        int nextId = 1;
+        TaskSegments segments;
+        // Segment years already merged into the store
+        std::set<int> loadedYears;
+        // Years with a changed task; only their segments are written back
+        std::set<int> dirtyYears;
+        // The task file still holds every task itself, so all of them are loaded and the next save
+        // splits it into segments
+        bool singleFile = false;
+        TaskArchive archive;
+        // Archive months already merged into the store
+        std::set<uint32_t> loadedArchiveMonths;
+    };
+
+    // A task line split into views of the file contents
+    struct ParsedTask;
+
+    TaskStore store;
+    std::vector<Calendar> calendars;
+    AsyncFdSink stdoutSink;
+    OutputSink* sink;
+    SinkStreamBuf sinkBuf;
+    std::ostream out;
+    std::string bannerCache;
+    int bannerYear;
+    int bannerMonth;
+    int bannerCellWidth;
+    std::string bannerColor;
+    FrameCache frames;
     static int CELL_WIDTH;
     static int CELL_HEIGHT;
     static int ICS_VALUE;
@@ -40,10 +81,40 @@ private:
     static int TEXT_BOLD;
     static int EVENT_DISPLAY;
     static json configFile;
-    static int CALENDAR_HEIGHT;
+    static int ARCHIVE_AFTER_DAYS;
     void loadTasks();
+    static void parseTaskLines(std::string_view content, std::vector<ParsedTask>& tasks);
+    size_t mergeTasks(uint8_t calendar, const std::vector<ParsedTask>& tasks, bool archived);
+    // Merges the segments wanted (by calendar index and segment) that are not loaded yet
+    void loadYearsWhere(const std::function<bool(size_t, const TaskSegments::Segment&)>& wanted);
+    // Segments that can hold deadlines on the local dates firstDay..lastDay (days since the epoch)
+    void loadDays(int64_t firstDay, int64_t lastDay);
+    void loadPendingYears();
+    void loadAllYears();
+    // Segments a bulk command's selector can reach
+    void loadSelected(const TaskSelector& selector);
+    // Everything a listing shows: segments with pending tasks, or with all every segment and the archive
+    void loadListed(bool all);
+    // Segments and archive month behind a month view
+    void loadMonth(int year, int month);
+    void loadArchivedMonth(int year, int month);
+    void loadArchivedMonths(const std::vector<uint32_t>& months);
+    void loadArchive();
+    size_t archiveOldTasks();
+    void resortStore();
+    size_t findTask(int id, uint8_t calendar);
+    // UTC year of the row's deadline, which picks its segment
+    int segmentYear(size_t row) const;
+    void markDirty(size_t row);
+    // Appends the task file line of a row: id|description|deadline|completed[|tags[|priority]]
+    void appendTaskLine(std::string& buffer, size_t row) const;
     void saveTasks();
+    const std::string& calendarColor(uint8_t calendar) const;
+    // "id", or "name:id" once several calendars are open
+    std::string taskLabel(int id, uint8_t calendar) const;
     void loadConfigs();
+    bool readConfigFile();
+    void writeConfigFile();
     void clearScreen();
     void moveCursor(int row, int col);
     void saveCursor();
@@ -53,18 +124,67 @@ private:
     std::string getCurrentDateTime();
     std::string getExecutableDirectory();
     bool isValidDateTime(const std::string& dateTime);
+    int terminalRows();
+    size_t idColumnWidth() const;
+    void printTaskHeader();
+    void printDeadlines(const std::vector<DeadlineIndex::Entry>& entries);
+    void exportEntries(RecordWriter::Format format, const std::vector<DeadlineIndex::Entry>& entries);
+    size_t printTaskRows(bool all, size_t firstRow, size_t count, const TagFilter& filter);
+    // Rows of the listing (all, or pending only) that pass the filter
+    std::vector<uint32_t> filteredRows(bool all, const TagFilter& filter) const;
+    void printNoTagged(const std::vector<std::string>& tags);
+    // Writes the month grid to out in the given layout; renderMonth serves repeat requests from the frame cache
+    void drawMonth(int year, int month, int selectedDay, const std::vector<std::string>& tags, const CalendarLayout& layout);
     
 public:
-    TaskManager(const std::string& file);
-    std::string color_text(const std::string& text, const std::string& color, const int bold = TaskManager::TEXT_BOLD);
-    void printYearAndMonth(int year, int month);
-    size_t count_utf8_characters_wstring(const std::string& str);
-    void addTask(const std::string& description, const std::string& deadline);
-    void listTasks(bool all = true);
-    void listTasksByDay(int month, int day);
-    void completeTask(int id);
-    void deleteTask(int id);
+    TaskManager(const std::string& file, OutputSink* outputSink = nullptr);
+    // The first source is the primary calendar; plain ids and new tasks refer to it
+    TaskManager(const std::vector<CalendarSource>& sources, OutputSink* outputSink = nullptr);
+    void setOutputSink(OutputSink* outputSink);
+    OutputSink& getOutputSink();
+    std::ostream& output();
+    std::string color_text(std::string_view text, const std::string& color, const int bold = TaskManager::TEXT_BOLD);
+    void printYearAndMonth(int year, int month, const CalendarLayout& layout);
+    // Reads "#name" into a lowercase tag; tags start with a letter and hold letters, digits, '-', '_' and '/'
+    static bool parseTag(std::string_view word, std::string& tag);
+    // Reads "!high", "!medium" (or "!med"), "!low" and "!none"
+    static bool parsePriority(std::string_view word, TaskStore::Priority& priority);
+    // "high", "medium", "low", or empty for none
+    static std::string_view priorityName(TaskStore::Priority priority);
+    // deadline is a wall time in zone, or in local time when zone is null
+    void addTask(const std::string& description, const std::string& deadline, int calendar = 0,
+                 const std::vector<std::string>& tags = {}, TaskStore::Priority priority = TaskStore::NONE,
+                 const TimeZone* zone = nullptr);
+    void setTaskPriority(int id, TaskStore::Priority priority, int calendar = 0);
+    // The tags arguments below keep only tasks carrying every listed tag
+    void listTasks(bool all = true, int page = 0, const std::vector<std::string>& tags = {});
+    void pageTasks(bool all = true, const std::vector<std::string>& tags = {});
+    void listTasksByDay(CivilDate::YearMonth month, int day, const std::vector<std::string>& tags = {});
+    // Machine-readable forms of ls/lsa, the day view and upcoming/overdue, streamed from the store
+    void exportTasks(RecordWriter::Format format, bool all, const std::vector<std::string>& tags = {});
+    void exportTasksByDay(RecordWriter::Format format, CivilDate::YearMonth month, int day, const std::vector<std::string>& tags = {});
+    void exportDeadlines(RecordWriter::Format format, bool overdue, size_t count);
+    void exportTop(RecordWriter::Format format, size_t count);
+    void listBusyDays(CivilDate::YearMonth month);
+    // Completion per week (per month over long ranges), overdue lateness and tasks per weekday for
+    // the packed dates from..to; from 0 covers the whole history and to 0 ends today
+    void report(uint32_t from = 0, uint32_t to = 0);
+    void completeTask(int id, int calendar = 0);
+    void deleteTask(int id, int calendar = 0);
+    // Bulk forms: all targets are resolved in one scan and saved once
+    void completeTasks(const TaskSelector& selector);
+    void deleteTasks(const TaskSelector& selector);
     void clearTasks();
+    void archiveTasks();
+    // The next count pending deadlines from now, and every pending task already past its deadline
+    void listUpcoming(size_t count);
+    void listOverdue();
+    // The count most important pending tasks: highest priority first, then earliest deadline
+    void listTop(size_t count);
+    // Earliest pending deadline after the given minute (minutes since the epoch, UTC), or 0
+    uint64_t nextDeadlineAfter(uint64_t minute);
+    // Prints the tasks due at the minute and returns a one-line summary of them, empty when none are due
+    std::string announceDue(uint64_t minute);
     void help();
 
     // Getters 
@@ -77,10 +197,15 @@ public:
     static std::string getEventsColor();
     static int getTextBold();
     std::vector<Task> getMonthTask(int month);
-    int getMonthOfTask(std::string& deadline);
-    int getDayOfTask(std::string& deadline);
-    int getYearOfTask(std::string& deadline);
+    std::string_view getDescription(const Task& task) const;
+    std::string_view getDeadline(const Task& task) const;
+    static int getMonthOfTask(std::string_view deadline);
+    static int getDayOfTask(std::string_view deadline);
+    static int getYearOfTask(std::string_view deadline);
     int getEventDisplay();
+    // Index of the named calendar, or -1
+    int findCalendar(const std::string& name) const;
+    size_t calendarCount() const;
     
     // Setters
     void setCalendarCellWidth(int newWidth);
@@ -92,10 +217,17 @@ public:
     void toggleCalendarBorderBold();
     void toggleTextBold();
     void toggleEventDisplay();
+    void setDurability(const std::string& durability, int groupCommitMs);
     
-    void displayCalendar(int month, bool useStaticDisplay = true);
+    void displayCalendar(CivilDate::YearMonth month, bool useStaticDisplay = true, const std::vector<std::string>& tags = {});
     void displayCalendar(const std::string& month);
+    // Draws one month of an absolute year; selectedDay is shown in reverse video
+    void renderMonth(int year, int month, int selectedDay = 0, const std::vector<std::string>& tags = {});
+    // Tasks of a single day, clipped to maxRows lines of at most maxColumns terminal columns
+    void renderDayDetail(int year, int month, int day, int maxRows, int maxColumns);
     static int calculateCalendarHeight();
+    // Cell geometry for the current terminal, within the configured CELL_WIDTH and CELL_HEIGHT
+    static const CalendarLayout& calendarLayout();
     void displaySummary();
     void sortByID();
     void sortByDeadlineAscending();
@@ -0,0 +1,58 @@
+#ifndef TASK_SEGMENTS_H
+#define TASK_SEGMENTS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Active tasks of a calendar, split by the UTC year of their deadline into one file per year,
+// "<task file>.years/<year>.dat" (in the task file line format). The task file itself holds a
+// short manifest of each segment's size, task counts and id range, so opening a calendar reads
+// only the manifest and single years load on their own. A task file that still holds task lines
+// is handed back whole and turns into a manifest the next time it is written.
+class TaskSegments {
+public:
+    struct Segment {
+        int year;
+        uint64_t size;
+        uint32_t taskCount;
+        uint32_t pendingCount;
+        int32_t minId;
+        int32_t maxId;
+        // The file does not match the manifest (e.g. a crash came between writing the two), so the
+        // counts and ids above are unknown until it is loaded
+        bool stale;
+    };
+
+    enum class Layout {
+        MISSING,
+        SINGLE_FILE,
+        SEGMENTED
+    };
+
+    void setPath(const std::string& taskFile);
+    const std::string& getPath() const;
+
+    // Reads the manifest; a task file in the old single-file layout is read into contents instead
+    Layout open(std::string& contents);
+    int maxId() const;
+    // Sorted by year
+    const std::vector<Segment>& segments() const;
+
+    // Appends the year's task lines to lines
+    bool readYear(int year, std::string& lines) const;
+    // Replaces the given years (empty lines drop the year), then rewrites the manifest
+    bool write(const std::map<int, std::string>& linesByYear);
+    // Drops every segment and leaves an empty manifest
+    void clear();
+
+private:
+    std::string path;
+    std::vector<Segment> index;
+
+    std::string segmentPath(int year) const;
+    bool writeManifest();
+};
+
+#endif
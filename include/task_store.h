@@ -0,0 +1,170 @@
+#ifndef TASK_STORE_H
+#define TASK_STORE_H
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "string_arena.h"
+#include "deadline_index.h"
+#include "daily_stats.h"
+
+struct Task {
+    int id;
+    StringRef description;
+    StringRef deadline;
+    bool completed;
+    int month;
+    int day;
+    int year;
+};
+
+// Targets of a bulk command; a task matches when every criterion that is set holds
+struct TaskSelector {
+    int firstId = INT_MIN;
+    int lastId = INT_MAX;
+    bool completedOnly = false;
+    bool pendingOnly = false;
+    // Packed dates (see TaskStore::packDate); 0 leaves the criterion unset
+    uint32_t before = 0;
+    uint32_t onDate = 0;
+    // Index of the owning calendar; -1 matches every loaded calendar
+    int calendar = -1;
+};
+
+// Tasks carrying every tag of a filter, as sorted task keys (see TaskStore::key). An empty tag
+// list is an inactive filter that matches everything.
+struct TagFilter {
+    bool active = false;
+    std::vector<uint64_t> keys;
+
+    bool matches(uint64_t key) const;
+};
+
+// Column-oriented task storage. The fields scanned by filters and the calendar
+// (id, packed date, status flags) live in their own contiguous arrays; the
+// description and deadline text is kept apart in the string arena. Each deadline
+// is held both as a UTC instant and, for display, as the packed date and
+// "YYYY-MM-DD HH:MM" text of that instant in the local zone.
+class TaskStore {
+public:
+    enum Flag : uint8_t {
+        COMPLETED = 1,
+        // Row was loaded from (or moved to) the task archive and is not written to the task file
+        ARCHIVED = 2,
+        // Two bits holding the row's Priority
+        PRIORITY_MASK = 12
+    };
+
+    enum Priority : uint8_t {
+        NONE = 0,
+        LOW = 1,
+        MEDIUM = 2,
+        HIGH = 3
+    };
+
+    static const size_t npos = static_cast<size_t>(-1);
+
+    // Per-day counters for one month, kept up to date on every mutation
+    struct MonthAggregate {
+        uint32_t total[32] = {};
+        uint32_t completed[32] = {};
+        // Bit d is set when day d has at least one task
+        uint32_t occupied = 0;
+    };
+
+    // Dates are packed as year << 9 | month << 5 | day so they compare chronologically
+    static uint32_t packDate(int year, int month, int day);
+    static int yearOf(uint32_t date);
+    static int monthOf(uint32_t date);
+    static int dayOf(uint32_t date);
+
+    size_t size() const;
+    bool empty() const;
+    // instant is the deadline in minutes since the epoch (UTC); date and deadline are its local
+    // date and wall time. zone is a TimeZone id, 0 when the deadline was given in the local zone.
+    // tags is a comma-separated list of tag names without the leading '#'.
+    size_t add(int id, uint32_t date, std::string_view description, std::string_view deadline, int64_t instant, bool completed,
+               uint8_t calendar = 0, std::string_view tags = {}, Priority priority = NONE, uint16_t zone = 0);
+    void remove(size_t row);
+    // Removes many rows in one pass; rows must be sorted ascending
+    void removeRows(const std::vector<uint32_t>& rows);
+    void clear();
+    // Ids are only unique within a calendar
+    size_t find(int id, uint8_t calendar = 0) const;
+
+    int id(size_t row) const;
+    uint8_t calendar(size_t row) const;
+    // Identifies a task across calendars: calendar << 32 | id
+    static uint64_t key(uint8_t calendar, int id);
+    uint64_t key(size_t row) const;
+    std::string_view tags(size_t row) const;
+    uint32_t date(size_t row) const;
+    bool completed(size_t row) const;
+    void setCompleted(size_t row, bool completed);
+    bool archived(size_t row) const;
+    void setArchived(size_t row);
+    Priority priority(size_t row) const;
+    void setPriority(size_t row, Priority priority);
+    std::string_view description(size_t row) const;
+    // Terminal columns taken by the description, computed once when the task is added
+    uint16_t descriptionWidth(size_t row) const;
+    std::string_view deadline(size_t row) const;
+    int64_t instant(size_t row) const;
+    uint16_t zone(size_t row) const;
+    std::string_view view(StringRef ref) const;
+    Task row(size_t row) const;
+
+    // Rows matching the selector in ascending order, found in one scan of the id, date and flag columns
+    std::vector<uint32_t> select(const TaskSelector& selector) const;
+    size_t countPending() const;
+    // Row index of the n-th pending task in display order, or npos when there are fewer
+    size_t nthPending(size_t n) const;
+    const MonthAggregate* monthAggregate(int year, int month) const;
+    uint32_t busyDays(int year, int month) const;
+    // Per-day counts by local date, for totals over arbitrary date ranges
+    const DailyStats& dailyStats() const;
+    std::vector<uint32_t> rowsOnDate(uint32_t date) const;
+    // Intersects the posting lists of the given tags, smallest first
+    TagFilter tagFilter(const std::vector<std::string>& tags) const;
+    // Pending tasks by deadline and by priority; built on first use and kept up to date on every
+    // mutation after that
+    const DeadlineIndex& pendingDeadlines() const;
+    std::array<std::vector<uint32_t>, 32> rowsByDay(int year, int month) const;
+
+    void sortById();
+    void sortByDate(bool ascending);
+    // Changes with every mutation, so anything derived from the store can tell when it is stale
+    uint64_t generation() const;
+
+private:
+    std::vector<int> ids;
+    std::vector<uint32_t> dates;
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> calendars;
+    std::vector<StringRef> descriptions;
+    std::vector<StringRef> deadlines;
+    std::vector<int64_t> instants;
+    std::vector<uint16_t> zones;
+    std::vector<uint16_t> descriptionWidths;
+    std::vector<StringRef> tagLists;
+    StringArena strings;
+    // Sorted task keys of every task carrying each tag
+    std::unordered_map<std::string, std::vector<uint64_t>> postings;
+    std::unordered_map<uint32_t, MonthAggregate> aggregates;
+    DailyStats daily;
+    mutable DeadlineIndex deadlineIndex;
+    mutable bool deadlinesIndexed = false;
+    uint64_t generationCount = 0;
+
+    void account(uint32_t date, int64_t instant, int totalDelta, int completedDelta);
+    void post(size_t row, bool add);
+    DeadlineIndex::Entry deadlineEntry(size_t row) const;
+    void permute(const std::vector<uint32_t>& order);
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TERMINAL_UI_H
+#define TERMINAL_UI_H
+
+#include <cstddef>
+#include "task_manager.h"
+
+// Full-screen calendar driven by single keystrokes. The terminal is put in raw mode, every
+// key already waiting on stdin is applied before drawing, and each burst of input produces
+// at most one redraw.
+class TerminalUI {
+public:
+    explicit TerminalUI(TaskManager& manager);
+    void run();
+
+private:
+    enum class Key {
+        NONE, LEFT, RIGHT, UP, DOWN, NEXT_MONTH, PREVIOUS_MONTH, TODAY, QUIT
+    };
+
+    TaskManager& manager;
+    int year;
+    int month;
+    int day;
+
+    // Decodes the key at the start of data and returns how many bytes it used
+    static size_t decodeKey(const char* data, size_t length, Key& key);
+    void moveDays(int delta);
+    void moveMonths(int delta);
+    void goToToday();
+    void render();
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef TIME_ZONE_H
+#define TIME_ZONE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Wall-clock fields of an instant
+struct CivilTime {
+    int year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+};
+
+// An IANA time zone read from the system tzdb ($TZDIR or /usr/share/zoneinfo). Each zone's TZif
+// transition table is parsed once and cached for the life of the process, and the POSIX rule at
+// the end of the file is expanded into transitions up to LAST_EXPANDED_YEAR, so converting an
+// instant is a binary search with no libc time calls. Zones are safe to use from any thread.
+class TimeZone {
+public:
+    static const int LAST_EXPANDED_YEAR = 2200;
+
+    // The named zone, or nullptr when the tzdb has no such zone
+    static const TimeZone* find(std::string_view name);
+    // Zones get small ids as they are loaded; 0 is never used, so it can mean "no zone"
+    static const TimeZone* byId(uint16_t id);
+    // The zone tasks are shown in: $TZ, else /etc/localtime, else UTC
+    static const TimeZone& local();
+
+    // Seconds since the epoch of a wall-clock time, and back, without any zone applied
+    static int64_t toSeconds(const CivilTime& time);
+    static CivilTime toCivil(int64_t seconds);
+    // Reads "YYYY-MM-DD" or "YYYY-MM-DD HH:MM" (single-digit months and days are accepted)
+    static bool parseWallTime(std::string_view text, int64_t& seconds);
+    // Writes "YYYY-MM-DD HH:MM" with the given date/time separator; returns the length (16)
+    static size_t formatWallTime(int64_t seconds, char separator, char* out);
+
+    uint16_t id() const;
+    const std::string& name() const;
+    // Offset from UTC in seconds at a UTC instant
+    int offsetAt(int64_t utcSeconds) const;
+    int64_t toLocal(int64_t utcSeconds) const;
+    // A wall time skipped by a forward jump moves forward by the gap; a repeated one takes the earlier instant
+    int64_t toUtc(int64_t localSeconds) const;
+    // The current wall-clock time in this zone
+    CivilTime now() const;
+
+private:
+    std::string zoneName;
+    uint16_t zoneId = 0;
+    // Offset in effect before the first transition
+    int32_t initialOffset = 0;
+    // Sorted UTC instants, and the offset that takes effect at each
+    std::vector<int64_t> transitions;
+    std::vector<int32_t> offsets;
+
+    static const TimeZone* load(const std::string& name, const std::string& path);
+    bool parseTzif(const std::string& data);
+    bool applyRule(std::string_view rule);
+};
+
+#endif
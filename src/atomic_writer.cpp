@@ -0,0 +1,220 @@
+#include "../include/atomic_writer.h"
+#include "../include/perf_stats.h"
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void syncPath(const std::string& path, bool directory) {
+#ifndef _WIN32
+    PerfStats::ScopedTimer timer(PerfStats::FSYNC);
+    int fd = ::open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+    if (fd < 0) return;
+    ::fsync(fd);
+    ::close(fd);
+#else
+    (void)path;
+    (void)directory;
+#endif
+}
+
+std::string parentDirectory(const std::string& path) {
+    fs::path parent = fs::path(path).parent_path();
+    return parent.empty() ? "." : parent.string();
+}
+
+struct State {
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+    // Directories holding renames that have not been synced yet
+    std::set<std::string> dirty;
+    AtomicWriter::Durability durability = AtomicWriter::Durability::SYNC;
+    std::chrono::milliseconds interval{100};
+    bool stopping = false;
+
+    ~State() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+
+    // Group commit: sleeps one interval after the first unsynced rename, then syncs the batch
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wakeup.wait(lock, [this] { return stopping || !dirty.empty(); });
+            if (dirty.empty()) break;
+            if (!stopping) {
+                wakeup.wait_for(lock, interval, [this] { return stopping; });
+            }
+            std::set<std::string> batch;
+            batch.swap(dirty);
+            lock.unlock();
+            syncAll(batch);
+            lock.lock();
+        }
+    }
+
+    static void syncAll(const std::set<std::string>& directories) {
+        for (const std::string& directory : directories) {
+            syncPath(directory, true);
+        }
+    }
+};
+
+State& state() {
+    static State instance;
+    return instance;
+}
+
+}
+
+void AtomicWriter::setPolicy(Durability durability, std::chrono::milliseconds groupInterval) {
+    State& s = state();
+    bool drain;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        drain = s.durability == Durability::GROUP && durability != Durability::GROUP;
+        s.durability = durability;
+        s.interval = groupInterval;
+    }
+    if (drain) flush();
+}
+
+AtomicWriter::Durability AtomicWriter::getDurability() {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.durability;
+}
+
+bool AtomicWriter::parseDurability(const std::string& name, Durability& durability) {
+    if (name == "SYNC") {
+        durability = Durability::SYNC;
+    } else if (name == "GROUP") {
+        durability = Durability::GROUP;
+    } else if (name == "OS") {
+        durability = Durability::OS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* AtomicWriter::durabilityName(Durability durability) {
+    switch (durability) {
+        case Durability::SYNC: return "SYNC";
+        case Durability::GROUP: return "GROUP";
+        case Durability::OS: return "OS";
+    }
+    return "SYNC";
+}
+
+bool AtomicWriter::commit(const std::string& path, std::string_view contents) {
+    Durability durability = getDurability();
+    std::string tempPath = path + ".tmp";
+    PerfStats::increment(PerfStats::FILE_OPENS);
+
+#ifdef _WIN32
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        file.close();
+        if (!file) {
+            std::remove(tempPath.c_str());
+            std::cerr << "Error: Could not write " << tempPath << "; " << path << " was left unchanged." << std::endl;
+            return false;
+        }
+    }
+#else
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Could not create " << tempPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // Keep the permissions of the file being replaced
+    struct stat existing;
+    if (::stat(path.c_str(), &existing) == 0) {
+        ::fchmod(fd, existing.st_mode & 07777);
+    }
+
+    size_t offset = 0;
+    bool ok = true;
+    while (offset < contents.size()) {
+        ssize_t written = ::write(fd, contents.data() + offset, contents.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    // The data has to be on disk before the rename can replace the old file, or a crash may
+    // leave the new name pointing at an empty file; only OS skips this
+    if (ok && durability != Durability::OS) {
+        PerfStats::ScopedTimer timer(PerfStats::FSYNC);
+        ok = ::fsync(fd) == 0;
+    }
+    int error = errno;
+    if (::close(fd) != 0 && ok) {
+        ok = false;
+        error = errno;
+    }
+    if (!ok) {
+        ::unlink(tempPath.c_str());
+        std::cerr << "Error: Could not write " << tempPath << " (" << std::strerror(error) << "); " << path << " was left unchanged." << std::endl;
+        return false;
+    }
+#endif
+
+    std::error_code renameError;
+    fs::rename(tempPath, path, renameError);
+    if (renameError) {
+        std::remove(tempPath.c_str());
+        std::cerr << "Error: Could not replace " << path << ": " << renameError.message() << std::endl;
+        return false;
+    }
+
+    // The rename is only durable once the directory entry itself reaches the disk
+    if (durability == Durability::SYNC) {
+        syncPath(parentDirectory(path), true);
+    } else if (durability == Durability::GROUP) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.dirty.insert(parentDirectory(path));
+        if (!s.worker.joinable()) {
+            s.worker = std::thread(&State::run, &s);
+        }
+        s.wakeup.notify_one();
+    }
+    return true;
+}
+
+void AtomicWriter::flush() {
+    State& s = state();
+    std::set<std::string> batch;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        batch.swap(s.dirty);
+    }
+    State::syncAll(batch);
+}
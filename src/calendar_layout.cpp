@@ -0,0 +1,77 @@
+#include "../include/calendar_layout.h"
+#include <algorithm>
+#include <csignal>
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+const int CalendarLayout::MIN_CELL_WIDTH;
+const int CalendarLayout::MAX_CELL_WIDTH;
+const int CalendarLayout::MIN_CELL_HEIGHT;
+const int CalendarLayout::MAX_CELL_HEIGHT;
+
+namespace {
+
+volatile sig_atomic_t stale = 1;
+
+#ifndef _WIN32
+void onResize(int) {
+    CalendarLayout::invalidate();
+}
+#endif
+
+}
+
+CalendarLayout CalendarLayout::compute(int columns, int rows, int maxCellWidth, int maxCellHeight) {
+    CalendarLayout layout;
+    layout.cellWidth = std::max(std::min(maxCellWidth, MAX_CELL_WIDTH), MIN_CELL_WIDTH);
+    layout.cellHeight = std::max(std::min(maxCellHeight, MAX_CELL_HEIGHT), MIN_CELL_HEIGHT);
+    // Seven cells and the closing border across; the banner, weekday names, six weeks of
+    // cells with their borders and the prompt down
+    if (columns > 0) layout.cellWidth = std::max(std::min(layout.cellWidth, (columns - 1) / 7), MIN_CELL_WIDTH);
+    if (rows > 0) layout.cellHeight = std::max(std::min(layout.cellHeight, (rows - 9) / 6 - 1), MIN_CELL_HEIGHT);
+
+    layout.height = 8 + 6 * (layout.cellHeight + 1);
+    layout.eventRows = layout.cellHeight - 4;
+    layout.descriptionColumns = static_cast<size_t>(layout.cellWidth - 7);
+    layout.blankCell.assign(layout.cellWidth - 1, ' ');
+    layout.cellRule.assign(layout.cellWidth - 1, '*');
+    layout.weekdayGap.assign(layout.cellWidth - 2, ' ');
+    return layout;
+}
+
+const CalendarLayout& CalendarLayout::current(int maxCellWidth, int maxCellHeight) {
+    static CalendarLayout layout;
+    static int boundWidth = 0;
+    static int boundHeight = 0;
+    if (stale || maxCellWidth != boundWidth || maxCellHeight != boundHeight) {
+        stale = 0;
+#ifdef _WIN32
+        // No terminal size without ioctl, so the configured bounds are used as they are
+        layout = compute(0, 0, maxCellWidth, maxCellHeight);
+#else
+        winsize size = {};
+        if (!isatty(STDOUT_FILENO) || ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0) size = {};
+        layout = compute(size.ws_col, size.ws_row, maxCellWidth, maxCellHeight);
+#endif
+        boundWidth = maxCellWidth;
+        boundHeight = maxCellHeight;
+    }
+    return layout;
+}
+
+void CalendarLayout::invalidate() {
+    stale = 1;
+}
+
+void CalendarLayout::watchResize() {
+#ifndef _WIN32
+    struct sigaction action = {};
+    action.sa_handler = onResize;
+    // Restart interrupted reads so a resize never looks like the end of input
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGWINCH, &action, nullptr);
+#endif
+}
@@ -0,0 +1,103 @@
+#include "../include/daily_stats.h"
+#include "../include/civil_date.h"
+#include <algorithm>
+
+const int64_t DailyStats::FIRST_DAY;
+const int64_t DailyStats::LAST_DAY;
+
+static_assert(CivilDate::daysFromCivil(1900, 1, 1) == DailyStats::FIRST_DAY, "first day");
+static_assert(CivilDate::daysFromCivil(2200, 12, 31) == DailyStats::LAST_DAY, "last day");
+
+DailyStats::Totals& DailyStats::Totals::operator+=(const Totals& other) {
+    total += other.total;
+    completed += other.completed;
+    pendingMinutes += other.pendingMinutes;
+    return *this;
+}
+
+DailyStats::Totals DailyStats::Totals::operator-(const Totals& other) const {
+    Totals difference = *this;
+    difference.total -= other.total;
+    difference.completed -= other.completed;
+    difference.pendingMinutes -= other.pendingMinutes;
+    return difference;
+}
+
+void DailyStats::add(int64_t day, int totalDelta, int completedDelta, int64_t instant) {
+    if (day < FIRST_DAY || day > LAST_DAY) return;
+    stale = true;
+    // The range grows by at least its own size, so loading tasks in any date order stays linear
+    if (days.empty()) {
+        base = day;
+        days.resize(1);
+    } else if (day < base) {
+        int64_t newBase = std::max(FIRST_DAY, std::min(day, base - static_cast<int64_t>(days.size())));
+        days.insert(days.begin(), static_cast<size_t>(base - newBase), Totals());
+        base = newBase;
+    } else if (day - base >= static_cast<int64_t>(days.size())) {
+        int64_t needed = day - base + 1;
+        days.resize(static_cast<size_t>(std::min(std::max(needed, static_cast<int64_t>(days.size()) * 2), LAST_DAY - base + 1)));
+    }
+    Totals& totals = days[static_cast<size_t>(day - base)];
+    totals.total += totalDelta;
+    totals.completed += completedDelta;
+    totals.pendingMinutes += (totalDelta - completedDelta) * instant;
+}
+
+void DailyStats::clear() {
+    days.clear();
+    prefix.clear();
+    stride.clear();
+    stale = true;
+}
+
+void DailyStats::build() const {
+    prefix.assign(days.size() + 1, Totals());
+    stride.assign(days.size(), Totals());
+    for (size_t i = 0; i < days.size(); i++) {
+        prefix[i + 1] = prefix[i];
+        prefix[i + 1] += days[i];
+        stride[i] = days[i];
+        if (i >= 7) stride[i] += stride[i - 7];
+    }
+    stale = false;
+}
+
+DailyStats::Totals DailyStats::range(int64_t firstDay, int64_t lastDay) const {
+    firstDay = std::max(firstDay, base);
+    lastDay = std::min(lastDay, base + static_cast<int64_t>(days.size()) - 1);
+    if (firstDay > lastDay) return Totals();
+    if (stale) build();
+    return prefix[static_cast<size_t>(lastDay - base + 1)] - prefix[static_cast<size_t>(firstDay - base)];
+}
+
+DailyStats::Totals DailyStats::weekday(int64_t firstDay, int64_t lastDay, int weekday) const {
+    firstDay = std::max(firstDay, base);
+    lastDay = std::min(lastDay, base + static_cast<int64_t>(days.size()) - 1);
+    if (firstDay > lastDay) return Totals();
+    // The first and last days of the range that fall on the weekday
+    firstDay += (weekday - CivilDate::weekday(firstDay) + 7) % 7;
+    lastDay -= (CivilDate::weekday(lastDay) - weekday + 7) % 7;
+    if (firstDay > lastDay) return Totals();
+    if (stale) build();
+    size_t first = static_cast<size_t>(firstDay - base);
+    size_t last = static_cast<size_t>(lastDay - base);
+    return first >= 7 ? stride[last] - stride[first - 7] : stride[last];
+}
+
+bool DailyStats::span(int64_t& firstDay, int64_t& lastDay) const {
+    if (days.empty()) return false;
+    if (stale) build();
+    int64_t all = prefix.back().total;
+    if (all == 0) return false;
+    // prefix totals never decrease, so the ends are found by binary search
+    auto first = std::upper_bound(prefix.begin(), prefix.end(), 0, [](int64_t value, const Totals& totals) {
+        return value < totals.total;
+    });
+    auto last = std::lower_bound(prefix.begin(), prefix.end(), all, [](const Totals& totals, int64_t value) {
+        return totals.total < value;
+    });
+    firstDay = base + (first - prefix.begin()) - 1;
+    lastDay = base + (last - prefix.begin()) - 1;
+    return true;
+}
@@ -0,0 +1,62 @@
+#include "../include/deadline_index.h"
+#include <ctime>
+
+uint64_t DeadlineIndex::now() {
+    return static_cast<uint64_t>(time(0) / 60);
+}
+
+void DeadlineIndex::insert(const Entry& entry) {
+    entries.insert(entry);
+    byPriority.insert(entry);
+}
+
+void DeadlineIndex::erase(const Entry& entry) {
+    auto it = entries.find(entry);
+    if (it != entries.end()) entries.erase(it);
+    auto ranked = byPriority.find(entry);
+    if (ranked != byPriority.end()) byPriority.erase(ranked);
+}
+
+void DeadlineIndex::clear() {
+    entries.clear();
+    byPriority.clear();
+}
+
+size_t DeadlineIndex::size() const {
+    return entries.size();
+}
+
+std::vector<DeadlineIndex::Entry> DeadlineIndex::from(uint64_t minute, size_t count) const {
+    std::vector<Entry> result;
+    for (auto it = entries.lower_bound(Entry{minute, 0, INT32_MIN, {}, {}, {}, 0}); it != entries.end() && result.size() < count; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+std::vector<DeadlineIndex::Entry> DeadlineIndex::before(uint64_t minute) const {
+    std::vector<Entry> result;
+    auto end = entries.lower_bound(Entry{minute, 0, INT32_MIN, {}, {}, {}, 0});
+    for (auto it = entries.begin(); it != end; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+std::vector<DeadlineIndex::Entry> DeadlineIndex::at(uint64_t minute) const {
+    auto end = entries.lower_bound(Entry{minute + 1, 0, INT32_MIN, {}, {}, {}, 0});
+    return std::vector<Entry>(entries.lower_bound(Entry{minute, 0, INT32_MIN, {}, {}, {}, 0}), end);
+}
+
+uint64_t DeadlineIndex::nextAfter(uint64_t minute) const {
+    auto it = entries.lower_bound(Entry{minute + 1, 0, INT32_MIN, {}, {}, {}, 0});
+    return it == entries.end() ? 0 : it->minute;
+}
+
+std::vector<DeadlineIndex::Entry> DeadlineIndex::top(size_t count) const {
+    std::vector<Entry> result;
+    for (auto it = byPriority.begin(); it != byPriority.end() && result.size() < count; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
@@ -0,0 +1,213 @@
+#include "../include/display_width.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+struct Range {
+    uint32_t first;
+    uint32_t last;
+};
+
+// Combining marks, joiners, variation selectors and emoji modifiers
+const Range zeroWidth[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF}, {0x05C1, 0x05C2},
+    {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0610, 0x061A}, {0x064B, 0x065F}, {0x0670, 0x0670},
+    {0x06D6, 0x06DC}, {0x06DF, 0x06E4}, {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x0900, 0x0902},
+    {0x093A, 0x093A}, {0x093C, 0x093C}, {0x0941, 0x0948}, {0x094D, 0x094D}, {0x0951, 0x0957},
+    {0x0962, 0x0963}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E}, {0x1160, 0x11FF},
+    {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F}, {0x202A, 0x202E}, {0x2060, 0x2064},
+    {0x20D0, 0x20FF}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0x1F3FB, 0x1F3FF},
+    {0xE0000, 0xE007F}, {0xE0100, 0xE01EF}
+};
+
+// East Asian Wide/Fullwidth characters and emoji with default emoji presentation
+const Range wide[] = {
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC}, {0x23F0, 0x23F0},
+    {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653}, {0x267F, 0x267F},
+    {0x2693, 0x2693}, {0x26A1, 0x26A1}, {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5},
+    {0x26CE, 0x26CE}, {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+    {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B}, {0x2728, 0x2728},
+    {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755}, {0x2757, 0x2757}, {0x2795, 0x2797},
+    {0x27B0, 0x27B0}, {0x27BF, 0x27BF}, {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55},
+    {0x2E80, 0x303E}, {0x3041, 0x33FF}, {0x3400, 0x4DBF}, {0x4E00, 0x9FFF}, {0xA000, 0xA4CF},
+    {0xA960, 0xA97F}, {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6F},
+    {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6}, {0x16FE0, 0x16FE4}, {0x17000, 0x18AFF}, {0x1B000, 0x1B2FF},
+    {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A}, {0x1F200, 0x1F202},
+    {0x1F210, 0x1F23B}, {0x1F240, 0x1F248}, {0x1F250, 0x1F251}, {0x1F260, 0x1F265}, {0x1F300, 0x1F320},
+    {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C}, {0x1F37E, 0x1F393}, {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3},
+    {0x1F3E0, 0x1F3F0}, {0x1F3F4, 0x1F3F4}, {0x1F3F8, 0x1F43E}, {0x1F440, 0x1F440}, {0x1F442, 0x1F4FC},
+    {0x1F4FF, 0x1F53D}, {0x1F54B, 0x1F54E}, {0x1F550, 0x1F567}, {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596},
+    {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F}, {0x1F680, 0x1F6C5}, {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2},
+    {0x1F6D5, 0x1F6D7}, {0x1F6DC, 0x1F6DF}, {0x1F6EB, 0x1F6EC}, {0x1F6F4, 0x1F6FC}, {0x1F7E0, 0x1F7EB},
+    {0x1F7F0, 0x1F7F0}, {0x1F90C, 0x1F93A}, {0x1F93C, 0x1F945}, {0x1F947, 0x1F9FF}, {0x1FA70, 0x1FA7C},
+    {0x1FA80, 0x1FA89}, {0x1FA8F, 0x1FAC6}, {0x1FACE, 0x1FADC}, {0x1FADF, 0x1FAE9}, {0x1FAF0, 0x1FAF8},
+    {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}
+};
+
+const uint32_t ZERO_WIDTH_JOINER = 0x200D;
+const uint32_t EMOJI_PRESENTATION = 0xFE0F;
+const uint32_t REPLACEMENT = 0xFFFD;
+
+template <size_t N>
+bool inTable(const Range (&table)[N], uint32_t codePoint) {
+    const Range* end = table + N;
+    const Range* it = std::upper_bound(table, end, codePoint, [](uint32_t value, const Range& range) {
+        return value < range.first;
+    });
+    return it != table && codePoint <= (it - 1)->last;
+}
+
+bool isRegionalIndicator(uint32_t codePoint) {
+    return codePoint >= 0x1F1E6 && codePoint <= 0x1F1FF;
+}
+
+// Decodes one code point at pos and returns its length in bytes; malformed input decodes as U+FFFD
+size_t decode(std::string_view text, size_t pos, uint32_t& codePoint) {
+    unsigned char lead = static_cast<unsigned char>(text[pos]);
+    size_t length;
+    if (lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    } else if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        codePoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        codePoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        codePoint = lead & 0x07;
+    } else {
+        codePoint = REPLACEMENT;
+        return 1;
+    }
+    if (pos + length > text.size()) {
+        codePoint = REPLACEMENT;
+        return 1;
+    }
+    for (size_t i = 1; i < length; i++) {
+        unsigned char next = static_cast<unsigned char>(text[pos + i]);
+        if ((next & 0xC0) != 0x80) {
+            codePoint = REPLACEMENT;
+            return 1;
+        }
+        codePoint = (codePoint << 6) | (next & 0x3F);
+    }
+    return length;
+}
+
+// Returns the end of the grapheme cluster starting at pos and stores its width
+size_t nextCluster(std::string_view text, size_t pos, size_t& width) {
+    uint32_t codePoint;
+    size_t end = pos + decode(text, pos, codePoint);
+    width = static_cast<size_t>(DisplayWidth::codePointWidth(codePoint));
+
+    if (isRegionalIndicator(codePoint) && end < text.size()) {
+        uint32_t next;
+        size_t length = decode(text, end, next);
+        if (isRegionalIndicator(next)) {
+            end += length;
+            width = 2;
+        }
+    }
+
+    while (end < text.size()) {
+        uint32_t next;
+        size_t length = decode(text, end, next);
+        if (next == ZERO_WIDTH_JOINER) {
+            // The joined code point is drawn as part of the same glyph
+            end += length;
+            if (end < text.size()) {
+                end += decode(text, end, next);
+            }
+        } else if (next >= 0x80 && DisplayWidth::codePointWidth(next) == 0) {
+            if (next == EMOJI_PRESENTATION && width == 1) {
+                width = 2;
+            }
+            end += length;
+        } else {
+            break;
+        }
+    }
+    return end;
+}
+
+}
+
+int DisplayWidth::codePointWidth(uint32_t codePoint) {
+    if (codePoint < 0x80) return 1;
+    if (codePoint < 0xA0) return 0;
+    if (codePoint < 0x0300) return 1;
+    if (inTable(zeroWidth, codePoint)) return 0;
+    if (codePoint == ZERO_WIDTH_JOINER) return 0;
+    if (codePoint < 0x1100) return 1;
+    return inTable(wide, codePoint) ? 2 : 1;
+}
+
+size_t DisplayWidth::columns(std::string_view text) {
+    size_t total = 0;
+    size_t pos = 0;
+    const size_t size = text.size();
+    const char* data = text.data();
+    while (pos < size) {
+        // Fast path: whole runs of ASCII are one column per byte
+#if defined(__SSE2__)
+        while (pos + 16 <= size) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            if (_mm_movemask_epi8(chunk) != 0) break;
+            total += 16;
+            pos += 16;
+        }
+#endif
+        while (pos + 8 <= size) {
+            uint64_t word;
+            std::memcpy(&word, data + pos, sizeof(word));
+            if (word & 0x8080808080808080ULL) break;
+            total += 8;
+            pos += 8;
+        }
+        while (pos < size && static_cast<unsigned char>(data[pos]) < 0x80) {
+            total++;
+            pos++;
+        }
+        if (pos >= size) break;
+
+        size_t width;
+        pos = nextCluster(text, pos, width);
+        total += width;
+    }
+    return total;
+}
+
+size_t DisplayWidth::truncate(std::string_view text, size_t maxColumns, size_t* usedColumns) {
+    size_t pos = 0;
+    size_t total = 0;
+    while (pos < text.size()) {
+        size_t width;
+        size_t end = nextCluster(text, pos, width);
+        if (total + width > maxColumns) break;
+        total += width;
+        pos = end;
+    }
+    if (usedColumns) *usedColumns = total;
+    return pos;
+}
+
+std::string DisplayWidth::ellipsize(std::string_view text, size_t textColumns, size_t maxColumns, size_t* usedColumns) {
+    if (textColumns <= maxColumns) {
+        if (usedColumns) *usedColumns = textColumns;
+        return std::string(text);
+    }
+    if (maxColumns < 3) {
+        return std::string(text.substr(0, truncate(text, maxColumns, usedColumns)));
+    }
+    size_t used;
+    std::string result(text.substr(0, truncate(text, maxColumns - 3, &used)));
+    result += "...";
+    if (usedColumns) *usedColumns = used + 3;
+    return result;
+}
@@ -0,0 +1,32 @@
+#include "../include/frame_cache.h"
+#include <iterator>
+
+bool FrameCache::Key::operator==(const Key& other) const {
+    return year == other.year && month == other.month && selectedDay == other.selectedDay && cellWidth == other.cellWidth &&
+           cellHeight == other.cellHeight && eventDisplay == other.eventDisplay && borderBold == other.borderBold &&
+           textBold == other.textBold && generation == other.generation && borderColor == other.borderColor &&
+           textColor == other.textColor && eventsColor == other.eventsColor && tags == other.tags;
+}
+
+const std::string* FrameCache::find(const Key& key) {
+    for (auto it = frames.begin(); it != frames.end(); ++it) {
+        if (it->first == key) {
+            frames.splice(frames.begin(), frames, it);
+            return &frames.front().second;
+        }
+    }
+    return nullptr;
+}
+
+void FrameCache::insert(Key key, std::string frame) {
+    // Frames from older generations can never match again, so they go first
+    for (auto it = frames.begin(); it != frames.end();) {
+        it = it->first.generation != key.generation ? frames.erase(it) : std::next(it);
+    }
+    frames.emplace_front(std::move(key), std::move(frame));
+    if (frames.size() > CAPACITY) frames.pop_back();
+}
+
+void FrameCache::clear() {
+    frames.clear();
+}
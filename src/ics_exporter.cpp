@@ -0,0 +1,164 @@
+#include "../include/ics_exporter.h"
+#include "../include/perf_stats.h"
+#include "../include/time_zone.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#ifdef _WIN32
+#include <cstdlib>
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+constexpr std::chrono::milliseconds IcsExporter::COALESCE_WINDOW;
+constexpr std::chrono::milliseconds IcsExporter::MAX_DELAY;
+
+IcsExporter::~IcsExporter() {
+    finish();
+}
+
+void IcsExporter::enqueue(const std::string& icsPath, const std::string& description, int64_t utcSeconds, const std::string& zone,
+                          bool launch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) return;
+    auto now = std::chrono::steady_clock::now();
+    if (pending.empty()) firstQueued = now;
+    lastQueued = now;
+    path = icsPath;
+    pending.push_back({description, utcSeconds, zone});
+    launchPending = launchPending || launch;
+    if (!worker.joinable()) {
+        worker = std::thread(&IcsExporter::run, this);
+    }
+    wakeup.notify_one();
+}
+
+void IcsExporter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void IcsExporter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeup.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty()) break;
+
+        // Let a burst of adds finish before exporting, unless we are shutting down
+        while (!stopping) {
+            auto deadline = std::min(lastQueued + COALESCE_WINDOW, firstQueued + MAX_DELAY);
+            if (std::chrono::steady_clock::now() >= deadline) break;
+            wakeup.wait_until(lock, deadline);
+        }
+
+        std::vector<Event> events;
+        events.swap(pending);
+        std::string icsPath = path;
+        bool launchApp = launchPending;
+        launchPending = false;
+        lock.unlock();
+
+        if (writeFile(icsPath, events) && launchApp) {
+            launch(icsPath);
+        }
+
+        lock.lock();
+    }
+}
+
+// "YYYYMMDDTHHMM00", the iCalendar DATE-TIME form
+void IcsExporter::formatStamp(const CivilTime& time, char* out) {
+    std::snprintf(out, 32, "%04d%02d%02dT%02d%02d00", time.year, time.month, time.day, time.hour, time.minute);
+}
+
+bool IcsExporter::writeFile(const std::string& icsPath, const std::vector<Event>& events) {
+    std::ofstream file(icsPath);
+    if (!file) {
+        std::cerr << "Error: Could not create task.ics file." << std::endl;
+        return false;
+    }
+    PerfStats::increment(PerfStats::ICS_EXPORTS);
+
+    std::time_t now = std::time(nullptr);
+    char dtStamp[32];
+    formatStamp(TimeZone::toCivil(now), dtStamp);
+
+    file << "BEGIN:VCALENDAR\n";
+    file << "VERSION:2.0\n";
+    file << "PRODID:-//EV+ Task Manager//EN\n";
+    size_t written = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        // Zoned events keep their wall time under TZID; the rest are written as UTC
+        const TimeZone* zone = events[i].zone.empty() ? nullptr : TimeZone::find(events[i].zone);
+        char dtStart[32];
+        formatStamp(TimeZone::toCivil(zone ? zone->toLocal(events[i].utcSeconds) : events[i].utcSeconds), dtStart);
+        std::string start = zone ? ";TZID=" + zone->name() + ":" + dtStart : ":" + std::string(dtStart) + "Z";
+
+        file << "BEGIN:VEVENT\n";
+        file << "UID:" << now << "-" << i << "@taskmanager.local\n";
+        file << "DTSTAMP:" << dtStamp << "Z\n";
+        file << "DTSTART" << start << "\n";
+        file << "DTEND" << start << "\n";
+        file << "SUMMARY:" << events[i].description << "\n";
+        file << "DESCRIPTION:" << events[i].description << "\n";
+        file << "STATUS:CONFIRMED\n";
+        file << "TRANSP:OPAQUE\n";
+        file << "END:VEVENT\n";
+        written++;
+    }
+    file << "END:VCALENDAR\n";
+    file.close();
+    return written > 0;
+}
+
+void IcsExporter::launch(const std::string& icsPath) {
+    PerfStats::increment(PerfStats::APP_LAUNCHES);
+    #ifdef _WIN32
+        std::string cmd = "start \"\" \"" + icsPath + "\"";
+        system(cmd.c_str());
+    #else
+        #ifdef __APPLE__
+            const char* opener = "open";
+        #else
+            const char* opener = "xdg-open";
+        #endif
+        // Spawn the opener directly rather than through a shell, with its output silenced
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+        // Some openers stay around until the viewer closes, so earlier launches are reaped
+        // without blocking and never hold up the next export or shutdown
+        static std::vector<pid_t> children;
+        children.erase(std::remove_if(children.begin(), children.end(), [](pid_t child) {
+            return waitpid(child, nullptr, WNOHANG) != 0;
+        }), children.end());
+
+        std::string target = icsPath;
+        char* argv[] = {const_cast<char*>(opener), &target[0], nullptr};
+        pid_t pid;
+        int error = posix_spawnp(&pid, opener, &actions, nullptr, argv, environ);
+        if (error == 0) {
+            children.push_back(pid);
+        } else {
+            std::cerr << "Error: Could not launch " << opener << ": " << std::strerror(error) << std::endl;
+        }
+        posix_spawn_file_actions_destroy(&actions);
+    #endif
+}
@@ -1,5 +1,12 @@
 #include "../include/task_manager.h"
+#include "../include/perf_stats.h"
+#include "../include/output_sink.h"
+#include "../include/terminal_ui.h"
+#include "../include/ics_exporter.h"
+#include "../include/atomic_writer.h"
+#include "../include/reminder.h"
 #include <sstream>
+#include <cstdio>
 #include <cstring>
 #include <ctime>
 #include <fstream>
@@ -8,6 +15,7 @@
 #include <algorithm>
 #include <nlohmann/json.hpp>
 #include <filesystem>
+#include <optional>
 #include <stdexcept>
 
 using json = nlohmann::json;
@@ -16,10 +24,18 @@ using namespace std;
 
 void processCommand(TaskManager& manager, const std::string& command);
 
+std::string readLine(TaskManager& manager) {
+    // Make sure any pending prompt reaches the terminal before blocking on input
+    manager.output().flush();
+    std::string input;
+    std::getline(std::cin, input);
+    return input;
+}
+
 
-time_t now = time(0);
-tm *ltm = localtime(&now);
-int monthNumber = 1 + ltm->tm_mon;
+// The month that c, n, p, dc and the day-number command work on
+CivilDate::YearMonth shownMonth = {TimeZone::local().now().year, TimeZone::local().now().month};
+IcsExporter icsExporter;
 
 std::string getExecutableDirectory(){
     #ifdef _WIN32
@@ -55,120 +71,265 @@ int main(int argc, char* argv[]) {
     }
     
     std::string dataFile = srcDirectory + "/tasks.dat";
-    
-    if (argc > 1 && std::strcmp(argv[1], "--file") == 0 && argc > 2) {
-        dataFile = argv[2];
+    std::vector<TaskManager::CalendarSource> calendarSources;
+    bool dumpStats = false;
+    bool quiet = false;
+    std::string fullCommand;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--file") == 0) {
+            if (i + 1 < argc) {
+                std::string path = argv[++i];
+                calendarSources.push_back({fs::path(path).stem().string(), path});
+            }
+            continue;
+        }
+        if (std::strcmp(argv[i], "--calendar") == 0) {
+            if (i + 1 < argc) {
+                std::string source = argv[++i];
+                size_t equals = source.find('=');
+                if (equals == std::string::npos || equals == 0 || equals + 1 == source.size()) {
+                    std::cerr << "Error: --calendar expects <name>=<file>." << std::endl;
+                    return 1;
+                }
+                calendarSources.push_back({source.substr(0, equals), source.substr(equals + 1)});
+            }
+            continue;
+        }
+        if (std::strcmp(argv[i], "--stats") == 0) {
+            dumpStats = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+            continue;
+        }
+        fullCommand += std::string(argv[i]) + " ";
     }
 
-    TaskManager manager(dataFile);
-    
-    std::cout << manager.color_text("Task Manager CLI (Type 'h' for commands, 'exit' to quit)", manager.getTextColor()) << std::endl;
-
-    if ((argc > 1 && std::strcmp(argv[1], "--file") != 0) || argc > 3) {
-        std::string fullCommand;
-        for (int i = 1; i < argc; i++) {
-            if (i > 1 && std::strcmp(argv[i-1], "--file") == 0) {
-                continue;
-            }
-            if (std::strcmp(argv[i], "--file") == 0) {
-                i++;
-                continue;
+    if (calendarSources.empty()) {
+        calendarSources.push_back({"tasks", dataFile});
+    }
+    if (calendarSources.size() > 255) {
+        std::cerr << "Error: At most 255 calendars can be open at once." << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < calendarSources.size(); i++) {
+        const std::string& name = calendarSources[i].name;
+        if (name.find_first_of(": \t@") != std::string::npos) {
+            std::cerr << "Error: Calendar name '" << name << "' may not contain ':', '@' or spaces." << std::endl;
+            return 1;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (calendarSources[j].name == name) {
+                std::cerr << "Error: Two calendars are named '" << name << "'; name them with --calendar <name>=<file>." << std::endl;
+                return 1;
             }
-            fullCommand += std::string(argv[i]) + " ";
         }
-        processCommand(manager, fullCommand);
-        return 0;
     }
 
-    std::string input;
-    while (true) {
-        std::cout << manager.color_text("> ", manager.getTextColor());
-        std::getline(std::cin, input);
+    CalendarLayout::watchResize();
+    NullSink nullSink;
+    TaskManager manager(calendarSources, quiet ? &nullSink : nullptr);
+    std::ostream& out = manager.output();
+    
+    // Machine-readable output is meant for other programs, so it goes out without the banner
+    if (fullCommand.find("--format=") == std::string::npos) {
+        out << manager.color_text("Task Manager CLI (Type 'h' for commands, 'exit' to quit)", manager.getTextColor()) << "\n";
+    }
 
-        if (input == "exit") break;
+    if (!fullCommand.empty()) {
+        processCommand(manager, fullCommand);
+    } else {
+        while (true) {
+            out << manager.color_text("> ", manager.getTextColor());
+            out.flush();
+            std::string input;
+            if (!std::getline(std::cin, input)) break;
+
+            if (input == "exit") break;
 
-        processCommand(manager, input);
+            processCommand(manager, input);
+            out.flush();
+        }
     }
 
+    out.flush();
+    icsExporter.finish();
+    AtomicWriter::flush();
+    // On a terminal the output sink writes from its own thread; the last of stdout has to be
+    // out before the report goes to stderr
+    manager.getOutputSink().drain();
+    if (dumpStats) {
+        PerfStats::report(std::cerr);
+    }
     return 0;
 }
 
-void exportToICSFile(const std::string& description, const std::string& deadline, TaskManager& manager) {
-    std::string executableDirectory = getExecutableDirectory();
-    std::string srcDirectory = executableDirectory;
-    std::string icsPath = srcDirectory + "/task.ics";
-    std::ofstream file(icsPath);
-    if (!file) {
-        std::cerr << "Error: Could not create task.ics file." << std::endl;
-        return;
+// Hands the new task to the background exporter; the file is written and the calendar app opened
+// once the burst of adds settles, so nt never waits on disk or process startup
+void exportToICSFile(const std::string& description, const std::string& deadline, const TimeZone* zone, TaskManager& manager) {
+    int64_t wall;
+    if (!TimeZone::parseWallTime(deadline, wall)) return;
+    std::string icsPath = getExecutableDirectory() + "/task.ics";
+    int64_t utc = (zone ? *zone : TimeZone::local()).toUtc(wall);
+    icsExporter.enqueue(icsPath, description, utc, zone ? zone->name() : std::string(), manager.getICSVal() == 1);
+}
+
+bool parseDate(const std::string& text, uint32_t& packed) {
+    int year, month, day;
+    char extra;
+    if (std::sscanf(text.c_str(), "%4d-%2d-%2d%c", &year, &month, &day, &extra) != 3) return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+    packed = TaskStore::packDate(year, month, day);
+    return true;
+}
+
+// Splits the calendar name off "name:id"; plain ids belong to the primary calendar
+bool parseCalendarPrefix(TaskManager& manager, std::string& arg, int& calendar, std::string& error) {
+    size_t colon = arg.find(':');
+    calendar = 0;
+    if (colon == std::string::npos) return true;
+    std::string name = arg.substr(0, colon);
+    calendar = manager.findCalendar(name);
+    if (calendar < 0) {
+        error = "Unknown calendar '" + name + "'.";
+        return false;
     }
+    arg = arg.substr(colon + 1);
+    return true;
+}
 
-    std::tm tm = {};
-    std::istringstream ss(deadline);
-    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M");
-    if (ss.fail()) {
-        std::cerr << "Error: Invalid deadline format." << std::endl;
-        return;
+// Reads the bulk forms of ft and dt: an id range "first-last" (optionally "name:first-last"),
+// @name and/or --completed, --pending, --before YYYY-MM-DD and --day YYYY-MM-DD
+bool parseTaskSelector(TaskManager& manager, const std::vector<std::string>& args, TaskSelector& selector, std::string& error) {
+    if (args.empty()) {
+        error = "Invalid task ID.";
+        return false;
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+        std::string arg = args[i];
+        if (arg.size() > 1 && arg[0] == '@') {
+            selector.calendar = manager.findCalendar(arg.substr(1));
+            if (selector.calendar < 0) {
+                error = "Unknown calendar '" + arg.substr(1) + "'.";
+                return false;
+            }
+        } else if (arg == "--completed") {
+            selector.completedOnly = true;
+        } else if (arg == "--pending") {
+            selector.pendingOnly = true;
+        } else if (arg == "--before" || arg == "--day") {
+            uint32_t& date = arg == "--before" ? selector.before : selector.onDate;
+            if (i + 1 >= args.size() || !parseDate(args[++i], date)) {
+                error = arg + " expects a date (YYYY-MM-DD).";
+                return false;
+            }
+        } else {
+            int first, last, calendar;
+            char extra;
+            std::string original = arg;
+            if (!parseCalendarPrefix(manager, arg, calendar, error)) return false;
+            if (std::sscanf(arg.c_str(), "%d-%d%c", &first, &last, &extra) != 2 || first < 0 || last < first) {
+                arg = original;
+                error = "Invalid task ID or option '" + arg + "'. Use <id>, <first>-<last>, @<calendar>, --completed, --pending, --before <date> or --day <date>.";
+                return false;
+            }
+            selector.firstId = first;
+            selector.lastId = last;
+            selector.calendar = calendar;
+        }
     }
+    if (selector.completedOnly && selector.pendingOnly) {
+        error = "--completed and --pending cannot be combined.";
+        return false;
+    }
+    return true;
+}
 
-    char dtStart[32];
-    std::strftime(dtStart, sizeof(dtStart), "%Y%m%dT%H%M00", &tm);
-
-    std::time_t now = std::time(nullptr);
-    std::tm* now_tm = std::gmtime(&now);
-    char dtStamp[32];
-    std::strftime(dtStamp, sizeof(dtStamp), "%Y%m%dT%H%M00Z", now_tm);
-
-    file << "BEGIN:VCALENDAR\n";
-    file << "VERSION:2.0\n";
-    file << "PRODID:-//EV+ Task Manager//EN\n";
-    file << "BEGIN:VEVENT\n";
-    file << "UID:" << now << "@taskmanager.local\n";
-    file << "DTSTAMP:" << dtStamp << "\n";
-    file << "DTSTART;TZID=America/New_York:" << dtStart << "\n";
-    file << "DTEND;TZID=America/New_York:" << dtStart << "\n";
-    file << "SUMMARY:" << description << "\n";
-    file << "DESCRIPTION:" << description << "\n";
-    file << "STATUS:CONFIRMED\n";
-    file << "TRANSP:OPAQUE\n";
-    file << "END:VEVENT\n";
-    file << "END:VCALENDAR\n";
-    file.close();
-
-    int icsVal = manager.getICSVal();
-    if (icsVal == 1){
-        #ifdef _WIN32
-            std::string cmd = "start \"\" \"" + icsPath + "\"";
-            system(cmd.c_str()); 
-        #elif __APPLE__
-            std::string cmd = "open \"" + icsPath + "\"";
-            system(cmd.c_str());
-        #else
-            std::string cmd = "xdg-open \"" + icsPath + "\" 2>/dev/null &";
-            system(cmd.c_str()); 
-        #endif
+// Pulls "--format=<jsonl|csv|tsv>" out of a command's arguments and returns the other arguments
+std::string takeFormatOption(std::istream& args, std::optional<RecordWriter::Format>& format, std::string& error) {
+    std::string rest, arg;
+    while (args >> arg) {
+        if (arg.rfind("--format=", 0) != 0) {
+            rest += arg + " ";
+            continue;
+        }
+        RecordWriter::Format parsed;
+        if (RecordWriter::parseFormat(arg.substr(9), parsed)) {
+            format = parsed;
+        } else {
+            error = "Unknown format '" + arg.substr(9) + "'. Use jsonl, csv or tsv.";
+        }
+    }
+    return rest;
+}
+
+// Pulls "#tag" filters out of a command's arguments and returns the other arguments
+std::string takeTagFilters(std::istream& args, std::vector<std::string>& tags) {
+    std::string rest, arg, tag;
+    while (args >> arg) {
+        if (TaskManager::parseTag(arg, tag)) {
+            tags.push_back(tag);
+        } else {
+            rest += arg + " ";
+        }
     }
+    return rest;
 }
 
 void processCommand(TaskManager& manager, const std::string& command) {
+    PerfStats::ScopedTimer timer(PerfStats::PROCESS_COMMAND);
+    std::ostream& out = manager.output();
     std::istringstream iss(command);
     std::string cmd;
     iss >> cmd;
     try {
         int day = std::stoi(cmd);
-        int daysInMonth[] = { 31,28,31,30,31,30,31,31,30,31,30,31};
-        if (day <= daysInMonth[monthNumber - 1] && day > 0){
-            manager.listTasksByDay(monthNumber, day);
+        std::optional<RecordWriter::Format> format;
+        std::string error;
+        std::vector<std::string> tags;
+        std::istringstream args(takeFormatOption(iss, format, error));
+        takeTagFilters(args, tags);
+        if (!error.empty()) {
+            out << manager.color_text("Error: " + error, manager.getTextColor()) << "\n";
+        }
+        else if (day <= shownMonth.days() && day > 0){
+            if (format) manager.exportTasksByDay(*format, shownMonth, day, tags);
+            else manager.listTasksByDay(shownMonth, day, tags);
         }
         else {
-             std::cout << "Invalid day for the current month." << std::endl;
+             out << "Invalid day for the current month." << "\n";
         }
     } catch (const std::invalid_argument& e){
         if (cmd == "nt") {
             std::string description, deadline;
+            std::vector<std::string> tags;
+            TaskStore::Priority priority = TaskStore::NONE;
+            const TimeZone* zone = nullptr;
             std::getline(iss, description);
+            int calendar = 0;
             if (!description.empty()) {
                 description = description.substr(1);
+                // "nt @name ..." adds the task to that calendar
+                if (description.size() > 1 && description[0] == '@') {
+                    size_t space = description.find(' ');
+                    int named = manager.findCalendar(description.substr(1, space == std::string::npos ? std::string::npos : space - 1));
+                    if (named >= 0) {
+                        calendar = named;
+                        description = space == std::string::npos ? "" : description.substr(space + 1);
+                    }
+                }
+            }
+            if (!description.empty()) {
+                // A trailing zone name ("Europe/Berlin", "UTC") says which zone the deadline is in
+                size_t zoneSpace = description.rfind(' ');
+                if (zoneSpace != std::string::npos) {
+                    std::string zoneName = description.substr(zoneSpace + 1);
+                    if (zoneName.find('/') != std::string::npos || zoneName == "UTC") {
+                        zone = TimeZone::find(zoneName);
+                        if (zone) description.erase(zoneSpace);
+                    }
+                }
 
                 size_t lastSpace = description.rfind(" ");
                 if (lastSpace != std::string::npos) {
@@ -194,84 +355,167 @@ void processCommand(TaskManager& manager, const std::string& command) {
                 }
                 
                 if (deadline.empty()) {
-                    time_t now = time(0);
-                    tm *ltm = localtime(&now);
+                    CivilTime today = (zone ? *zone : TimeZone::local()).now();
                     char dateStr[32];
-                    std::strftime(dateStr, sizeof(dateStr), "%Y-%m-%d 23:59", ltm);
+                    std::snprintf(dateStr, sizeof(dateStr), "%04d-%02d-%02d 23:59", today.year, today.month, today.day);
                     deadline = std::string(dateStr);
                 }
-                
-                manager.addTask(description, deadline);
-                exportToICSFile(description, deadline, manager);
+
+                // "#name" words are tags and "!high" style words the priority, not part of the description
+                std::istringstream words(description);
+                std::string word, tag, untagged;
+                bool marked = false;
+                while (words >> word) {
+                    if (TaskManager::parseTag(word, tag)) {
+                        tags.push_back(tag);
+                        marked = true;
+                    } else if (TaskManager::parsePriority(word, priority)) {
+                        marked = true;
+                    } else {
+                        untagged += (untagged.empty() ? "" : " ") + word;
+                    }
+                }
+                if (marked) description = untagged;
+            }
+            if (!description.empty()) {
+                manager.addTask(description, deadline, calendar, tags, priority, zone);
+                exportToICSFile(description, deadline, zone, manager);
             } else {
-                std::cout << manager.color_text("Error: Task description cannot be empty.", manager.getTextColor()) << std::endl;
+                out << manager.color_text("Error: Task description cannot be empty.", manager.getTextColor()) << "\n";
             }
-        } else if (cmd == "ls") {
-            manager.listTasks(false);
-        } else if (cmd == "lsa") {
-            manager.listTasks(true);
-        } else if (cmd == "ft") {
-            int id;
-            if (iss >> id) {
-                manager.completeTask(id);
+        } else if (cmd == "ls" || cmd == "lsa") {
+            bool all = cmd == "lsa";
+            std::optional<RecordWriter::Format> format;
+            std::string error;
+            std::vector<std::string> tags;
+            std::istringstream formatArgs(takeFormatOption(iss, format, error));
+            std::istringstream args(takeTagFilters(formatArgs, tags));
+            std::string option;
+            int page;
+            if (!error.empty()) {
+                out << manager.color_text("Error: " + error, manager.getTextColor()) << "\n";
+            } else if (format && !(args >> option)) {
+                manager.exportTasks(*format, all, tags);
+            } else if (format) {
+                out << manager.color_text("Error: --format cannot be combined with paging options.", manager.getTextColor()) << "\n";
+            } else if (!(args >> option)) {
+                manager.listTasks(all, 0, tags);
+            } else if (option == "--pager") {
+                manager.pageTasks(all, tags);
+            } else if (option == "-p" && args >> page && page > 0) {
+                manager.listTasks(all, page, tags);
             } else {
-                std::cout << manager.color_text("Error: Invalid task ID.", manager.getTextColor()) << std::endl; 
+                out << manager.color_text("Error: Usage: " + cmd + " [#tag ...] [-p <page>] | [--pager] | [--format=jsonl|csv|tsv]", manager.getTextColor()) << "\n";
             }
-        } else if (cmd == "dt") {
+        } else if (cmd == "ft" || cmd == "dt") {
+            std::vector<std::string> args;
+            std::string arg;
+            while (iss >> arg) args.push_back(arg);
+
             int id;
-            if (iss >> id) {
-                manager.deleteTask(id);
+            int calendar = 0;
+            std::string single = args.size() == 1 ? args[0] : "";
+            TaskSelector selector;
+            std::string error;
+            if (args.size() == 1 && parseCalendarPrefix(manager, single, calendar, error)
+                && std::all_of(single.begin(), single.end(), ::isdigit) && !single.empty()) {
+                id = std::stoi(single);
+                if (cmd == "ft") manager.completeTask(id, calendar);
+                else manager.deleteTask(id, calendar);
+            } else if (error.empty() && parseTaskSelector(manager, args, selector, error)) {
+                if (cmd == "ft") manager.completeTasks(selector);
+                else manager.deleteTasks(selector);
+            } else {
+                out << manager.color_text("Error: " + error, manager.getTextColor()) << "\n"; 
+            }
+        } else if (cmd == "archive") {
+            manager.archiveTasks();
+        } else if (cmd == "pr") {
+            std::string target, level;
+            int calendar = 0;
+            std::string error;
+            TaskStore::Priority priority;
+            if (!(iss >> target >> level) || !TaskManager::parsePriority("!" + level, priority)) {
+                out << manager.color_text("Error: Usage: pr <id> <high|medium|low|none>", manager.getTextColor()) << "\n";
+            } else if (!parseCalendarPrefix(manager, target, calendar, error)) {
+                out << manager.color_text("Error: " + error, manager.getTextColor()) << "\n";
+            } else if (target.empty() || !std::all_of(target.begin(), target.end(), ::isdigit)) {
+                out << manager.color_text("Error: Invalid task ID.", manager.getTextColor()) << "\n";
+            } else {
+                manager.setTaskPriority(std::stoi(target), priority, calendar);
+            }
+        } else if (cmd == "upcoming" || cmd == "overdue" || cmd == "top") {
+            std::optional<RecordWriter::Format> format;
+            std::string error;
+            std::istringstream args(takeFormatOption(iss, format, error));
+            int count = 10;
+            if (!error.empty()) {
+                out << manager.color_text("Error: " + error, manager.getTextColor()) << "\n";
+            } else if (cmd != "overdue" && !(args >> count).fail() && (count < 1 || count > 100000)) {
+                out << manager.color_text("Error: Usage: " + cmd + " [N] with N between 1 and 100000", manager.getTextColor()) << "\n";
             } else {
-                std::cout << manager.color_text("Error: Invalid task ID.", manager.getTextColor()) << std::endl; 
+                if (count < 1) count = 10;
+                if (format && cmd == "top") manager.exportTop(*format, static_cast<size_t>(count));
+                else if (format) manager.exportDeadlines(*format, cmd == "overdue", static_cast<size_t>(count));
+                else if (cmd == "top") manager.listTop(static_cast<size_t>(count));
+                else if (cmd == "overdue") manager.listOverdue();
+                else manager.listUpcoming(static_cast<size_t>(count));
             }
+        } else if (cmd == "remind") {
+            Reminder reminder(manager);
+            reminder.run();
         } else if (cmd == "ct") {
-            std::cout << manager.color_text("Clearing all tasks...", manager.getTextColor()) << std::endl; 
+            out << manager.color_text("Clearing all tasks...", manager.getTextColor()) << "\n"; 
             manager.clearTasks();
         } else if (cmd == "h") {
             manager.help();
+        } else if (cmd == "stats") {
+            PerfStats::report(out);
         } else if (cmd == "c"){
-            monthNumber = ltm->tm_mon + 1;
-            manager.displayCalendar(monthNumber, true);
+            std::vector<std::string> tags;
+            takeTagFilters(iss, tags);
+            CivilTime today = TimeZone::local().now();
+            shownMonth = {today.year, today.month};
+            manager.displayCalendar(shownMonth, true, tags);
         } else if (cmd == "sh"){
             int newHeight;
             if (iss >> newHeight){
                 if (newHeight >= 5 && newHeight <= 10){
                     manager.setCalendarCellHeight(newHeight);
-                    cout << manager.color_text("The cell height of the calendar has been set to: ", manager.getTextColor()) << newHeight << "\n";
+                    out << manager.color_text("The cell height of the calendar has been set to: ", manager.getTextColor()) << newHeight << "\n";
                 } else {
-                    std::cout << manager.color_text("Error: Height must be between 5 and 10.\n", manager.getTextColor()); 
+                    out << manager.color_text("Error: Height must be between 5 and 10.\n", manager.getTextColor()); 
                 }
             } else {
-            std::cout << manager.color_text("Error: Invalid input.Please enter a number.", manager.getTextColor()) << std::endl; 
+            out << manager.color_text("Error: Invalid input.Please enter a number.", manager.getTextColor()) << "\n"; 
             }
         } else if (cmd == "sw") {
             int newWidth;
             if (iss >> newWidth) {
                 if (newWidth >= 13 && newWidth <= 40) {
                     manager.setCalendarCellWidth(newWidth);
-                    cout << manager.color_text("The cell width of the calendar has been set to: ", manager.getTextColor()) << newWidth << "\n";
+                    out << manager.color_text("The cell width of the calendar has been set to: ", manager.getTextColor()) << newWidth << "\n";
                 } else {
-                    std::cout << manager.color_text("Error: Width must be between 13 and 40.", manager.getTextColor()) << std::endl; 
+                    out << manager.color_text("Error: Width must be between 13 and 40.", manager.getTextColor()) << "\n"; 
                 }
             } else {
-                std::cout << manager.color_text("Error: Invalid input. Please enter a number.", manager.getTextColor()) << std::endl; 
+                out << manager.color_text("Error: Invalid input. Please enter a number.", manager.getTextColor()) << "\n"; 
             }
         } else if (cmd == "scc") {
             std::string text = "Welcome to Terminal Calendar";
 
-            std::cout << "Pick your calendar color (1-8): " << std::endl;
-            std::cout << "\033[30m" << "1. " + text << "\033[0m" << " (Black)\n";
-            std::cout << "\033[31m" << "2. " + text << "\033[0m" << " (Red)\n";
-            std::cout << "\033[32m" << "3. " + text << "\033[0m" << " (Green)\n";
-            std::cout << "\033[33m" << "4. " + text << "\033[0m" << " (Yellow)\n";
-            std::cout << "\033[34m" << "5. " + text << "\033[0m" << " (Blue)\n";
-            std::cout << "\033[35m" << "6. " + text << "\033[0m" << " (Magenta)\n";
-            std::cout << "\033[36m" << "7. " + text << "\033[0m" << " (Cyan)\n";
-            std::cout << "\033[37m" << "8. " + text << "\033[0m" << " (White)\n";
+            out << "Pick your calendar color (1-8): " << "\n";
+            out << "\033[30m" << "1. " + text << "\033[0m" << " (Black)\n";
+            out << "\033[31m" << "2. " + text << "\033[0m" << " (Red)\n";
+            out << "\033[32m" << "3. " + text << "\033[0m" << " (Green)\n";
+            out << "\033[33m" << "4. " + text << "\033[0m" << " (Yellow)\n";
+            out << "\033[34m" << "5. " + text << "\033[0m" << " (Blue)\n";
+            out << "\033[35m" << "6. " + text << "\033[0m" << " (Magenta)\n";
+            out << "\033[36m" << "7. " + text << "\033[0m" << " (Cyan)\n";
+            out << "\033[37m" << "8. " + text << "\033[0m" << " (White)\n";
 
             int choice;
-            std::string input;
-            std::getline(std::cin, input);  
+            std::string input = readLine(manager);
             std::istringstream inputStream(input);
 
             if (inputStream >> choice) {
@@ -301,29 +545,28 @@ void processCommand(TaskManager& manager, const std::string& command) {
                         manager.setCalendarBorderColor("WHITE");
                         break;
                     default:
-                        std::cout << manager.color_text("Unknown option. Please enter a valid option (1-8)", manager.getTextColor()) << std::endl; 
+                        out << manager.color_text("Unknown option. Please enter a valid option (1-8)", manager.getTextColor()) << "\n"; 
                         break;
                 }
             }
             else {
-                std::cout << manager.color_text("Invalid input. Please enter a valid choice (1-8)", manager.getTextColor()) << std::endl; 
+                out << manager.color_text("Invalid input. Please enter a valid choice (1-8)", manager.getTextColor()) << "\n"; 
             }
         } else if (cmd == "stc") {
             std::string text = "Welcome to Terminal Calendar";
 
-            std::cout << "Pick your text color (1-8):\n";
-            std::cout << "\033[30m" << "1. " + text << "\033[0m" << " (Black)\n";
-            std::cout << "\033[31m" << "2. " + text << "\033[0m" << " (Red)\n";
-            std::cout << "\033[32m" << "3. " + text << "\033[0m" << " (Green)\n";
-            std::cout << "\033[33m" << "4. " + text << "\033[0m" << " (Yellow)\n";
-            std::cout << "\033[34m" << "5. " + text << "\033[0m" << " (Blue)\n";
-            std::cout << "\033[35m" << "6. " + text << "\033[0m" << " (Magenta)\n";
-            std::cout << "\033[36m" << "7. " + text << "\033[0m" << " (Cyan)\n";
-            std::cout << "\033[37m" << "8. " + text << "\033[0m" << " (White)\n";
+            out << "Pick your text color (1-8):\n";
+            out << "\033[30m" << "1. " + text << "\033[0m" << " (Black)\n";
+            out << "\033[31m" << "2. " + text << "\033[0m" << " (Red)\n";
+            out << "\033[32m" << "3. " + text << "\033[0m" << " (Green)\n";
+            out << "\033[33m" << "4. " + text << "\033[0m" << " (Yellow)\n";
+            out << "\033[34m" << "5. " + text << "\033[0m" << " (Blue)\n";
+            out << "\033[35m" << "6. " + text << "\033[0m" << " (Magenta)\n";
+            out << "\033[36m" << "7. " + text << "\033[0m" << " (Cyan)\n";
+            out << "\033[37m" << "8. " + text << "\033[0m" << " (White)\n";
 
             int choice;
-            std::string input;
-            std::getline(std::cin, input);  
+            std::string input = readLine(manager);
             std::istringstream inputStream(input);
 
             if (inputStream >> choice) {
@@ -353,30 +596,29 @@ void processCommand(TaskManager& manager, const std::string& command) {
                         manager.setTextColor("WHITE");
                         break;
                     default:
-                        std::cout << manager.color_text("Unknown option. Please enter a valid option (1-8)", manager.getTextColor()) << std::endl;
+                        out << manager.color_text("Unknown option. Please enter a valid option (1-8)", manager.getTextColor()) << "\n";
                         break;    
                 }
             }
             else {
-                std::cout << manager.color_text("Invalid input. Please enter a valid choice (1-8)", manager.getTextColor()) << std::endl; 
+                out << manager.color_text("Invalid input. Please enter a valid choice (1-8)", manager.getTextColor()) << "\n"; 
             }
         } else if (cmd == "sec"){
 
             std::string text = "Events: ";
 
-            std::cout << "Pick your text color (1-8):\n";
-            std::cout << "\033[30m" << "1. " + text << "\033[0m" << " (Black)\n";
-            std::cout << "\033[31m" << "2. " + text << "\033[0m" << " (Red)\n";
-            std::cout << "\033[32m" << "3. " + text << "\033[0m" << " (Green)\n";
-            std::cout << "\033[33m" << "4. " + text << "\033[0m" << " (Yellow)\n";
-            std::cout << "\033[34m" << "5. " + text << "\033[0m" << " (Blue)\n";
-            std::cout << "\033[35m" << "6. " + text << "\033[0m" << " (Magenta)\n";
-            std::cout << "\033[36m" << "7. " + text << "\033[0m" << " (Cyan)\n";
-            std::cout << "\033[37m" << "8. " + text << "\033[0m" << " (White)\n";
+            out << "Pick your text color (1-8):\n";
+            out << "\033[30m" << "1. " + text << "\033[0m" << " (Black)\n";
+            out << "\033[31m" << "2. " + text << "\033[0m" << " (Red)\n";
+            out << "\033[32m" << "3. " + text << "\033[0m" << " (Green)\n";
+            out << "\033[33m" << "4. " + text << "\033[0m" << " (Yellow)\n";
+            out << "\033[34m" << "5. " + text << "\033[0m" << " (Blue)\n";
+            out << "\033[35m" << "6. " + text << "\033[0m" << " (Magenta)\n";
+            out << "\033[36m" << "7. " + text << "\033[0m" << " (Cyan)\n";
+            out << "\033[37m" << "8. " + text << "\033[0m" << " (White)\n";
 
             int choice;
-            std::string input;
-            std::getline(std::cin, input);  
+            std::string input = readLine(manager);
             std::istringstream inputStream(input);
 
             if (inputStream >> choice) {
@@ -406,24 +648,39 @@ void processCommand(TaskManager& manager, const std::string& command) {
                         manager.setEventsColor("WHITE");
                         break;
                     default:
-                        std::cout << manager.color_text("Unknown option. Please enter a valid option (1-8)", manager.getTextColor()) << std::endl;
+                        out << manager.color_text("Unknown option. Please enter a valid option (1-8)", manager.getTextColor()) << "\n";
                         break;    
                 }
             }
             else {
-                std::cout << manager.color_text("Invalid input. Please enter a valid choice (1-8)", manager.getTextColor()) << std::endl; 
+                out << manager.color_text("Invalid input. Please enter a valid choice (1-8)", manager.getTextColor()) << "\n"; 
+            }
+        } else if (cmd == "sd") {
+            std::string durability;
+            int groupCommitMs = 100;
+            AtomicWriter::Durability policy;
+            iss >> durability;
+            std::transform(durability.begin(), durability.end(), durability.begin(), ::toupper);
+            if (!AtomicWriter::parseDurability(durability, policy)) {
+                out << manager.color_text("Error: Durability must be SYNC, GROUP or OS.", manager.getTextColor()) << "\n";
+            } else if (!(iss >> groupCommitMs).fail() && (groupCommitMs < 1 || groupCommitMs > 60000)) {
+                out << manager.color_text("Error: The group commit interval must be between 1 and 60000 ms.", manager.getTextColor()) << "\n";
+            } else {
+                if (groupCommitMs < 1) groupCommitMs = 100;
+                manager.setDurability(durability, groupCommitMs);
+                std::string detail = policy == AtomicWriter::Durability::GROUP ? " (synced every " + std::to_string(groupCommitMs) + " ms)" : "";
+                out << manager.color_text("Saves now use " + durability + " durability" + detail + ".", manager.getTextColor()) << "\n";
             }
         } else if (cmd == "fetch"){
             manager.displaySummary(); 
         } else if (cmd == "scb"){
             std::string text = "***********************";
 
-            std::cout << manager.color_text("Do you want to toggle the boldness of your calendar borders? (y/n): \n", manager.getTextColor());
-            std::cout << manager.color_text("Your current calendar border: ", manager.getTextColor()) << std::string(11, ' ') << manager.color_text(text, manager.getCalendarBorderColor(), manager.getCalendarBorderBold()) << std::endl;
-            std::cout << manager.color_text("Your calendar border after the change: ", manager.getTextColor()) << "  " << manager.color_text(text, manager.getCalendarBorderColor(), manager.getCalendarBorderBold() ^ 1) << std::endl;
+            out << manager.color_text("Do you want to toggle the boldness of your calendar borders? (y/n): \n", manager.getTextColor());
+            out << manager.color_text("Your current calendar border: ", manager.getTextColor()) << std::string(11, ' ') << manager.color_text(text, manager.getCalendarBorderColor(), manager.getCalendarBorderBold()) << "\n";
+            out << manager.color_text("Your calendar border after the change: ", manager.getTextColor()) << "  " << manager.color_text(text, manager.getCalendarBorderColor(), manager.getCalendarBorderBold() ^ 1) << "\n";
             char choice;
-            std::string input;
-            std::getline(std::cin, input);  
+            std::string input = readLine(manager);
             std::istringstream inputStream(input);
             if (inputStream >> choice) {
                 switch(choice){
@@ -433,21 +690,20 @@ void processCommand(TaskManager& manager, const std::string& command) {
                     case 'n':
                         break;
                     default:
-                        std::cout << manager.color_text("Unknown option. Please enter a valid option (y/n)", manager.getTextColor()) << std::endl;
+                        out << manager.color_text("Unknown option. Please enter a valid option (y/n)", manager.getTextColor()) << "\n";
                         break;
                 }
             }
             else {
-                std::cout << manager.color_text("Invalid input. Please enter a valid choice (y/n)", manager.getTextColor()) << std::endl;
+                out << manager.color_text("Invalid input. Please enter a valid choice (y/n)", manager.getTextColor()) << "\n";
             }
         } else if (cmd == "stb"){
             std::string text = "Welcome to Terminal Calendar !";
-            std::cout << manager.color_text("Do you want to toggle the boldness of Terminal Calendar's text ? (y/n): \n", manager.getTextColor());
-            std::cout << manager.color_text("Your current text: ", manager.getTextColor()) << std::string(11, ' ') << manager.color_text(text, manager.getTextColor(), manager.getTextBold()) << std::endl;
-            std::cout << manager.color_text("Your text after the change: ", manager.getTextColor()) << "  " << manager.color_text(text, manager.getTextColor(), manager.getTextBold() ^ 1) << std::endl;
+            out << manager.color_text("Do you want to toggle the boldness of Terminal Calendar's text ? (y/n): \n", manager.getTextColor());
+            out << manager.color_text("Your current text: ", manager.getTextColor()) << std::string(11, ' ') << manager.color_text(text, manager.getTextColor(), manager.getTextBold()) << "\n";
+            out << manager.color_text("Your text after the change: ", manager.getTextColor()) << "  " << manager.color_text(text, manager.getTextColor(), manager.getTextBold() ^ 1) << "\n";
             char choice;
-            std::string input;
-            std::getline(std::cin, input);  
+            std::string input = readLine(manager);
             std::istringstream inputStream(input);
             if (inputStream >> choice) {
                 switch(choice){
@@ -457,17 +713,19 @@ void processCommand(TaskManager& manager, const std::string& command) {
                     case 'n':
                         break;
                     default:
-                        std::cout << manager.color_text("Unknown option. Please enter a valid option (y/n)", manager.getTextColor()) << std::endl;
+                        out << manager.color_text("Unknown option. Please enter a valid option (y/n)", manager.getTextColor()) << "\n";
                         break;
                 }
             }
             else {
-                std::cout << manager.color_text("Invalid input. Please enter a valid choice (y/n)", manager.getTextColor()) << std::endl;
+                out << manager.color_text("Invalid input. Please enter a valid choice (y/n)", manager.getTextColor()) << "\n";
             }
 
         } else if (cmd == "dc") {
             std::string inputMonth;
+            std::vector<std::string> tags;
             iss >> inputMonth; 
+            takeTagFilters(iss, tags);
             std::transform(inputMonth.begin(), inputMonth.end(), inputMonth.begin(), ::tolower);
 
             std::map<std::string, int> monthMap = {
@@ -475,63 +733,82 @@ void processCommand(TaskManager& manager, const std::string& command) {
                 {"may", 5}, {"june", 6}, {"july", 7}, {"august", 8},
                 {"september", 9}, {"october", 10}, {"november", 11}, {"december", 12}
             };
-            if (std::all_of(inputMonth.begin(), inputMonth.end(), ::isdigit)) {
-                monthNumber = std::stoi(inputMonth);
+            int month = 0;
+            if (!inputMonth.empty() && inputMonth.size() <= 2 && std::all_of(inputMonth.begin(), inputMonth.end(), ::isdigit)) {
+                month = std::stoi(inputMonth);
             } else if (monthMap.count(inputMonth)) {
-                monthNumber = monthMap[inputMonth];
+                month = monthMap[inputMonth];
             }
 
-            if (monthNumber >= 1 && monthNumber <= 12) {
-                manager.displayCalendar(monthNumber, true);
+            if (month >= 1 && month <= 12) {
+                shownMonth = {TimeZone::local().now().year, month};
+                manager.displayCalendar(shownMonth, true, tags);
             } else {
-                std::cout << manager.color_text("Invalid month. Please enter a number (1-12) or a valid month name.", manager.getTextColor()) << std::endl; 
-            }
-        } else if (cmd == "n") {
-            monthNumber ++;
-            manager.displayCalendar(monthNumber, true);
-        } else if (cmd == "p") {
-            monthNumber --;
-            manager.displayCalendar(monthNumber, true);
+                out << manager.color_text("Invalid month. Please enter a number (1-12) or a valid month name.", manager.getTextColor()) << "\n"; 
+            }
+        } else if (cmd == "busy") {
+            manager.listBusyDays(shownMonth);
+        } else if (cmd == "report") {
+            // report [all | <from> [<to>]]; the last twelve weeks by default
+            std::string first, second;
+            iss >> first >> second;
+            uint32_t from = 0, to = 0;
+            if (first.empty()) {
+                CivilTime today = TimeZone::local().now();
+                CivilDate::Date start = CivilDate::civilFromDays(CivilDate::daysFromCivil(today.year, today.month, today.day) - 12 * 7 + 1);
+                from = TaskStore::packDate(start.year, start.month, start.day);
+            }
+            if (first != "all" && !first.empty() && (!parseDate(first, from) || (!second.empty() && !parseDate(second, to)))) {
+                out << manager.color_text("Error: Usage: report [all | <YYYY-MM-DD> [<YYYY-MM-DD>]]", manager.getTextColor()) << "\n";
+            } else {
+                manager.report(from, to);
+            }
+        } else if (cmd == "ui") {
+            TerminalUI ui(manager);
+            ui.run();
+        } else if (cmd == "n" || cmd == "p") {
+            std::vector<std::string> tags;
+            takeTagFilters(iss, tags);
+            shownMonth = shownMonth.plus(cmd == "n" ? 1 : -1);
+            manager.displayCalendar(shownMonth, true, tags);
         } else if (cmd == "t"){
             int val = manager.getICSVal();
             if (val == 0){
-                std::cout << manager.color_text("Terminal Calendar is currently configured to not open your calendar app upon adding a new task. \nDo you want to configure it so that it opens your calendar app when adding a new task? (y/n)", manager.getTextColor()) << std::endl;
+                out << manager.color_text("Terminal Calendar is currently configured to not open your calendar app upon adding a new task. \nDo you want to configure it so that it opens your calendar app when adding a new task? (y/n)", manager.getTextColor()) << "\n";
                 char choice;
-                std::string input;
-                std::getline(std::cin, input);
+                std::string input = readLine(manager);
                 std::istringstream inputStream(input);
                 if (inputStream >> choice) {
                     switch (choice){
                         case 'y':
                             manager.toggleICS();
-                            std::cout << manager.color_text("Terminal Calendar has been configured to open your calendar app upon adding a new task!", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("Terminal Calendar has been configured to open your calendar app upon adding a new task!", manager.getTextColor()) << "\n";
                             break;
                         case 'n':
-                            std::cout << manager.color_text("No changes were made.", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("No changes were made.", manager.getTextColor()) << "\n";
                             break;
                         default:
-                            std::cout << manager.color_text("Unknown input. Please enter a valid input (y/n).", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("Unknown input. Please enter a valid input (y/n).", manager.getTextColor()) << "\n";
                             break;
                     }
                 }
             }
             else if (val == 1){
-                std::cout << manager.color_text("Terminal Calendar is currently configured to open your calendar app upon adding a new task. \nDo you want to configure it so that it does not open your calendar app when adding a new task? (y/n)", manager.getTextColor()) << std::endl;
+                out << manager.color_text("Terminal Calendar is currently configured to open your calendar app upon adding a new task. \nDo you want to configure it so that it does not open your calendar app when adding a new task? (y/n)", manager.getTextColor()) << "\n";
                 char choice;
-                std::string input;
-                std::getline(std::cin, input);
+                std::string input = readLine(manager);
                 std::istringstream inputStream(input);
                 if (inputStream >> choice) {
                     switch (choice){
                         case 'y':
                             manager.toggleICS();
-                            std::cout << manager.color_text("Terminal Calendar has been configured to not open your calendar app upon adding a new task!", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("Terminal Calendar has been configured to not open your calendar app upon adding a new task!", manager.getTextColor()) << "\n";
                             break;
                         case 'n':
-                            std::cout << manager.color_text("No changes were made.", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("No changes were made.", manager.getTextColor()) << "\n";
                             break;
                         default:
-                            std::cout << manager.color_text("Unknown input. Please enter a valid input (y/n).", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("Unknown input. Please enter a valid input (y/n).", manager.getTextColor()) << "\n";
                             break;
                     }
                 }
@@ -542,43 +819,41 @@ void processCommand(TaskManager& manager, const std::string& command) {
         } else if (cmd == "display"){
             int val = manager.getEventDisplay();
             if (val == 0){
-                std::cout << manager.color_text("Terminal Calendar is currently configured to display a summary of events for the day on the calendar. \nDo you want to configure it so that it lists the event descriptions on your calendar instead? (y/n)", manager.getTextColor()) << std::endl;
+                out << manager.color_text("Terminal Calendar is currently configured to display a summary of events for the day on the calendar. \nDo you want to configure it so that it lists the event descriptions on your calendar instead? (y/n)", manager.getTextColor()) << "\n";
                 char choice;
-                std::string input;
-                std::getline(std::cin, input);
+                std::string input = readLine(manager);
                 std::istringstream inputStream(input);
                 if (inputStream >> choice) {
                     switch (choice){
                         case 'y':
                             manager.toggleEventDisplay();
-                            std::cout << manager.color_text("Terminal Calendar has been configured to list task descriptions on your calendar!", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("Terminal Calendar has been configured to list task descriptions on your calendar!", manager.getTextColor()) << "\n";
                             break;
                         case 'n':
-                            std::cout << manager.color_text("No changes were made.", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("No changes were made.", manager.getTextColor()) << "\n";
                             break;
                         default:
-                            std::cout << manager.color_text("Unknown input. Please enter a valid input (y/n).", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("Unknown input. Please enter a valid input (y/n).", manager.getTextColor()) << "\n";
                             break;
                     }
                 }
             }
             else if (val == 1){
-                std::cout << manager.color_text("Terminal Calendar is currently configured to list task descriptions on the calendar. \nDo you want to configure it so that it does displays a summary of events for the day instead? (y/n)", manager.getTextColor()) << std::endl;
+                out << manager.color_text("Terminal Calendar is currently configured to list task descriptions on the calendar. \nDo you want to configure it so that it does displays a summary of events for the day instead? (y/n)", manager.getTextColor()) << "\n";
                 char choice;
-                std::string input;
-                std::getline(std::cin, input);
+                std::string input = readLine(manager);
                 std::istringstream inputStream(input);
                 if (inputStream >> choice) {
                     switch (choice){
                         case 'y':
                             manager.toggleEventDisplay();
-                            std::cout << manager.color_text("Terminal Calendar has been configured to display a summary of events for the day!", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("Terminal Calendar has been configured to display a summary of events for the day!", manager.getTextColor()) << "\n";
                             break;
                         case 'n':
-                            std::cout << manager.color_text("No changes were made.", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("No changes were made.", manager.getTextColor()) << "\n";
                             break;
                         default:
-                            std::cout << manager.color_text("Unknown input. Please enter a valid input (y/n).", manager.getTextColor()) << std::endl;
+                            out << manager.color_text("Unknown input. Please enter a valid input (y/n).", manager.getTextColor()) << "\n";
                             break;
                     }
                 }
@@ -587,36 +862,35 @@ void processCommand(TaskManager& manager, const std::string& command) {
                 std::cerr << manager.color_text("Error reading config file. Detected an invalid value.", manager.getTextColor()) << std::endl;
             }
         } else if (cmd == "sort"){
-            std::cout << manager.color_text("   Select how you want events to be sorted (1-3): ", manager.getTextColor()) << manager.color_text("\n   1. By ID", manager.getTextColor()) << manager.color_text("\n   2. By nearest", manager.getTextColor()) << manager.color_text("\n   3. By furthest", manager.getTextColor()) << manager.color_text("\n Your choice: ", manager.getTextColor()) ;
+            out << manager.color_text("   Select how you want events to be sorted (1-3): ", manager.getTextColor()) << manager.color_text("\n   1. By ID", manager.getTextColor()) << manager.color_text("\n   2. By nearest", manager.getTextColor()) << manager.color_text("\n   3. By furthest", manager.getTextColor()) << manager.color_text("\n Your choice: ", manager.getTextColor()) ;
             int choice;
-            std::string input;
-            std::getline(std::cin, input);  
+            std::string input = readLine(manager);
             std::istringstream inputStream(input);
 
             if (inputStream >> choice) {
                 switch (choice){
                     case 1:
                         manager.sortByID();
-                        std::cout << manager.color_text("Your events have successfully been sorted by their ID!", manager.getTextColor()) << std::endl; 
+                        out << manager.color_text("Your events have successfully been sorted by their ID!", manager.getTextColor()) << "\n"; 
                         break;
                     case 2:
                         manager.sortByDeadlineAscending();
-                        std::cout << manager.color_text("Your events have successfully been sorted by the nearest due date!", manager.getTextColor()) << std::endl; 
+                        out << manager.color_text("Your events have successfully been sorted by the nearest due date!", manager.getTextColor()) << "\n"; 
                         break;
                     case 3:
                         manager.sortByDeadlineDescending();
-                        std::cout << manager.color_text("Your events have successfully been sorted by the furthest due date!", manager.getTextColor()) << std::endl; 
+                        out << manager.color_text("Your events have successfully been sorted by the furthest due date!", manager.getTextColor()) << "\n"; 
                         break;
                     default:
-                        std::cout << manager.color_text("Unknown option. Please enter a valid choice (1-3)", manager.getTextColor()) << std::endl; 
+                        out << manager.color_text("Unknown option. Please enter a valid choice (1-3)", manager.getTextColor()) << "\n"; 
                         break;
                 }
             }
             else{
-                std::cout << manager.color_text("Invalid input. Please enter a valid choice (1-8)", manager.getTextColor()) << endl; 
+                out << manager.color_text("Invalid input. Please enter a valid choice (1-8)", manager.getTextColor()) << "\n"; 
             }
         } else {
-            std::cout << manager.color_text("Unknown command. Type 'h' for available commands.", manager.getTextColor()) << std::endl; 
+            out << manager.color_text("Unknown command. Type 'h' for available commands.", manager.getTextColor()) << "\n"; 
         }
     }
 }
@@ -0,0 +1,182 @@
+#include "../include/output_sink.h"
+#include "../include/perf_stats.h"
+#include <cerrno>
+#include <unistd.h>
+
+void BufferedSink::write(const char* data, size_t length) {
+    buffer.append(data, length);
+}
+
+const std::string& BufferedSink::str() const {
+    return buffer;
+}
+
+void BufferedSink::clear() {
+    buffer.clear();
+}
+
+void NullSink::write(const char*, size_t) {}
+
+bool NullSink::discards() const {
+    return true;
+}
+
+FdSink::FdSink(int fd, size_t capacity) : fd(fd), capacity(capacity), closed(false) {
+    pending.reserve(capacity);
+}
+
+FdSink::~FdSink() {
+    flush();
+}
+
+void FdSink::write(const char* data, size_t length) {
+    if (closed) return;
+    pending.append(data, length);
+    if (pending.size() >= capacity) {
+        flush();
+    }
+}
+
+void FdSink::flush() {
+    size_t offset = 0;
+    while (offset < pending.size()) {
+        ssize_t written = ::write(fd, pending.data() + offset, pending.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EPIPE) closed = true;
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    PerfStats::increment(PerfStats::TERMINAL_BYTES, offset);
+    pending.clear();
+}
+
+bool FdSink::discards() const {
+    return closed;
+}
+
+AsyncFdSink::AsyncFdSink(int fd, size_t capacity)
+    : fd(fd), capacity(capacity), threaded(isatty(fd) != 0), closed(false), frameStart(std::string::npos), writing(false), stopping(false) {
+    front.reserve(capacity);
+}
+
+AsyncFdSink::~AsyncFdSink() {
+    drain();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    if (writer.joinable()) writer.join();
+}
+
+void AsyncFdSink::write(const char* data, size_t length) {
+    if (closed) return;
+    front.append(data, length);
+    if (front.size() >= capacity) {
+        flush();
+    }
+}
+
+void AsyncFdSink::flush() {
+    handOver(false);
+}
+
+void AsyncFdSink::flushFrame() {
+    handOver(true);
+}
+
+void AsyncFdSink::handOver(bool frame) {
+    if (front.empty()) return;
+    if (!threaded) {
+        writeAll(front);
+        front.clear();
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (frame && frameStart != std::string::npos) {
+            // The previous frame never reached the terminal and this one draws over it anyway
+            back.resize(frameStart);
+            PerfStats::increment(PerfStats::FRAMES_DROPPED);
+        }
+        idle.wait(lock, [this] { return back.size() < MAX_BACKLOG || closed; });
+        frameStart = frame ? back.size() : std::string::npos;
+        back += front;
+        if (!writer.joinable()) writer = std::thread(&AsyncFdSink::run, this);
+    }
+    front.clear();
+    ready.notify_one();
+}
+
+void AsyncFdSink::drain() {
+    flush();
+    if (!threaded) return;
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return (back.empty() && !writing) || closed; });
+}
+
+bool AsyncFdSink::discards() const {
+    return closed;
+}
+
+void AsyncFdSink::writeAll(const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t written = ::write(fd, data.data() + offset, data.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EPIPE) closed = true;
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    PerfStats::increment(PerfStats::TERMINAL_BYTES, offset);
+}
+
+void AsyncFdSink::run() {
+    std::string sending;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        ready.wait(lock, [this] { return stopping || !back.empty(); });
+        if (back.empty()) break;
+        sending.swap(back);
+        frameStart = std::string::npos;
+        writing = true;
+        lock.unlock();
+        idle.notify_all();
+
+        writeAll(sending);
+        sending.clear();
+
+        lock.lock();
+        writing = false;
+        idle.notify_all();
+    }
+}
+
+SinkStreamBuf::SinkStreamBuf(OutputSink* sink) : sink(sink) {}
+
+void SinkStreamBuf::setSink(OutputSink* newSink) {
+    sink = newSink;
+}
+
+int SinkStreamBuf::overflow(int ch) {
+    if (ch == traits_type::eof()) {
+        return traits_type::not_eof(ch);
+    }
+    char c = traits_type::to_char_type(ch);
+    sink->write(&c, 1);
+    return ch;
+}
+
+std::streamsize SinkStreamBuf::xsputn(const char* s, std::streamsize n) {
+    sink->write(s, static_cast<size_t>(n));
+    return n;
+}
+
+int SinkStreamBuf::sync() {
+    sink->flush();
+    return 0;
+}
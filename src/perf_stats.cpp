@@ -0,0 +1,130 @@
+#include "../include/perf_stats.h"
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+std::atomic<uint64_t> PerfStats::counters[PerfStats::COUNTER_COUNT];
+PerfStats::Histogram PerfStats::histograms[PerfStats::TIMER_COUNT];
+
+static const char* counterNames[PerfStats::COUNTER_COUNT] = {
+    "File opens", "Terminal bytes", "Tasks parsed", "Tasks written", "ICS exports", "App launches", "Frame cache hits", "Frames dropped"
+};
+
+static const char* timerNames[PerfStats::TIMER_COUNT] = {
+    "loadTasks", "saveTasks", "sortTasks", "configRead", "configWrite", "processCommand", "displayCalendar", "loadArchive", "loadSegment", "fsync"
+};
+
+// Index of the highest set bit; value must not be zero
+static int highestBit(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#elif defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    int index = 0;
+    while (value >>= 1) index++;
+    return index;
+#endif
+}
+
+static std::string formatDuration(uint64_t nanoseconds) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    if (nanoseconds < 1000) {
+        oss << nanoseconds << "ns";
+    } else if (nanoseconds < 1000000) {
+        oss << nanoseconds / 1e3 << "us";
+    } else if (nanoseconds < 1000000000) {
+        oss << nanoseconds / 1e6 << "ms";
+    } else {
+        oss << nanoseconds / 1e9 << "s";
+    }
+    return oss.str();
+}
+
+PerfStats::ScopedTimer::ScopedTimer(Timer timer) : timer(timer), start(std::chrono::steady_clock::now()) {}
+
+PerfStats::ScopedTimer::~ScopedTimer() {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    PerfStats::record(timer, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void PerfStats::increment(Counter counter, uint64_t amount) {
+    counters[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+uint64_t PerfStats::get(Counter counter) {
+    return counters[counter].load(std::memory_order_relaxed);
+}
+
+void PerfStats::record(Timer timer, uint64_t nanoseconds) {
+    Histogram& histogram = histograms[timer];
+    int bucket = nanoseconds == 0 ? 0 : highestBit(nanoseconds);
+    if (bucket >= BUCKET_COUNT) bucket = BUCKET_COUNT - 1;
+    histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.total.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t previous = histogram.max.load(std::memory_order_relaxed);
+    while (nanoseconds > previous && !histogram.max.compare_exchange_weak(previous, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t PerfStats::percentile(const Histogram& histogram, double fraction) {
+    uint64_t count = histogram.count.load(std::memory_order_relaxed);
+    uint64_t target = static_cast<uint64_t>(std::ceil(count * fraction));
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += histogram.buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            // Report the upper bound of the bucket, capped by the observed maximum
+            uint64_t upper = 1ULL << (i + 1);
+            uint64_t max = histogram.max.load(std::memory_order_relaxed);
+            return upper < max ? upper : max;
+        }
+    }
+    return histogram.max.load(std::memory_order_relaxed);
+}
+
+void PerfStats::report(std::ostream& out) {
+    out << "Counters:" << std::endl;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        out << "  " << std::left << std::setw(18) << counterNames[i] << get(static_cast<Counter>(i)) << std::endl;
+    }
+    out << std::endl << "Latencies:" << std::endl;
+    out << "  " << std::left << std::setw(18) << "Operation" << std::setw(8) << "Count" << std::setw(10) << "Mean"
+        << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "Max" << std::endl;
+    for (int i = 0; i < TIMER_COUNT; i++) {
+        const Histogram& histogram = histograms[i];
+        uint64_t count = histogram.count.load(std::memory_order_relaxed);
+        out << "  " << std::left << std::setw(18) << timerNames[i] << std::setw(8) << count;
+        if (count == 0) {
+            out << "-" << std::endl;
+            continue;
+        }
+        out << std::setw(10) << formatDuration(histogram.total.load(std::memory_order_relaxed) / count)
+            << std::setw(10) << formatDuration(percentile(histogram, 0.50))
+            << std::setw(10) << formatDuration(percentile(histogram, 0.99))
+            << std::setw(10) << formatDuration(histogram.max.load(std::memory_order_relaxed)) << std::endl;
+    }
+}
+
+void PerfStats::reset() {
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto& histogram : histograms) {
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.total.store(0, std::memory_order_relaxed);
+        histogram.max.store(0, std::memory_order_relaxed);
+        for (auto& bucket : histogram.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
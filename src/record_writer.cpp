@@ -0,0 +1,136 @@
+#include "../include/record_writer.h"
+#include <charconv>
+
+bool RecordWriter::parseFormat(std::string_view name, Format& format) {
+    if (name == "jsonl") {
+        format = Format::JSONL;
+    } else if (name == "csv") {
+        format = Format::CSV;
+    } else if (name == "tsv") {
+        format = Format::TSV;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+RecordWriter::RecordWriter(OutputSink& sink, Format format) : sink(sink), format(format) {
+    buffer.reserve(FLUSH_SIZE + 1024);
+    if (format == Format::CSV) {
+        buffer += "id,calendar,description,deadline,tags,priority,status\n";
+    } else if (format == Format::TSV) {
+        buffer += "id\tcalendar\tdescription\tdeadline\ttags\tpriority\tstatus\n";
+    }
+}
+
+RecordWriter::~RecordWriter() {
+    finish();
+}
+
+void RecordWriter::field(std::string_view text) {
+    if (format == Format::JSONL) {
+        static const char HEX[] = "0123456789abcdef";
+        buffer += '"';
+        size_t plain = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            buffer.append(text.data() + plain, i - plain);
+            plain = i + 1;
+            switch (c) {
+                case '"': buffer += "\\\""; break;
+                case '\\': buffer += "\\\\"; break;
+                case '\n': buffer += "\\n"; break;
+                case '\r': buffer += "\\r"; break;
+                case '\t': buffer += "\\t"; break;
+                default:
+                    buffer += "\\u00";
+                    buffer += HEX[c >> 4];
+                    buffer += HEX[c & 0xF];
+            }
+        }
+        buffer.append(text.data() + plain, text.size() - plain);
+        buffer += '"';
+    } else if (format == Format::CSV) {
+        if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+            buffer += text;
+            return;
+        }
+        buffer += '"';
+        for (char c : text) {
+            if (c == '"') buffer += '"';
+            buffer += c;
+        }
+        buffer += '"';
+    } else {
+        size_t plain = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            char c = text[i];
+            if (c != '\\' && c != '\t' && c != '\n' && c != '\r') continue;
+            buffer.append(text.data() + plain, i - plain);
+            plain = i + 1;
+            buffer += '\\';
+            buffer += c == '\\' ? '\\' : c == '\t' ? 't' : c == '\n' ? 'n' : 'r';
+        }
+        buffer.append(text.data() + plain, text.size() - plain);
+    }
+}
+
+void RecordWriter::separator() {
+    buffer += format == Format::CSV ? ',' : '\t';
+}
+
+void RecordWriter::record(int id, std::string_view calendar, std::string_view description, std::string_view deadline,
+                          std::string_view tags, std::string_view priority, bool completed) {
+    char digits[16];
+    std::string_view idText(digits, static_cast<size_t>(std::to_chars(digits, digits + sizeof(digits), id).ptr - digits));
+    if (format == Format::JSONL) {
+        buffer += "{\"id\":";
+        buffer += idText;
+        buffer += ",\"calendar\":";
+        field(calendar);
+        buffer += ",\"description\":";
+        field(description);
+        buffer += ",\"deadline\":";
+        field(deadline);
+        buffer += ",\"tags\":[";
+        while (!tags.empty()) {
+            size_t comma = tags.find(',');
+            field(tags.substr(0, comma));
+            tags = comma == std::string_view::npos ? std::string_view() : tags.substr(comma + 1);
+            if (!tags.empty()) buffer += ',';
+        }
+        buffer += "],\"priority\":";
+        if (priority.empty()) {
+            buffer += "null";
+        } else {
+            field(priority);
+        }
+        buffer += completed ? ",\"completed\":true}\n" : ",\"completed\":false}\n";
+    } else {
+        buffer += idText;
+        separator();
+        field(calendar);
+        separator();
+        field(description);
+        separator();
+        field(deadline);
+        separator();
+        field(tags);
+        separator();
+        field(priority);
+        separator();
+        buffer += completed ? "completed\n" : "pending\n";
+    }
+    if (buffer.size() >= FLUSH_SIZE) {
+        sink.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+void RecordWriter::finish() {
+    if (!buffer.empty()) {
+        sink.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
@@ -0,0 +1,165 @@
+#include "../include/reminder.h"
+#include "../include/deadline_index.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
+extern char** environ;
+#endif
+
+Reminder::Reminder(TaskManager& manager) : manager(manager) {
+}
+
+#ifdef _WIN32
+
+// poll, posix_spawn and the interrupt handling below are POSIX only
+void Reminder::run() {
+    manager.output() << manager.color_text("Error: Reminders are not supported on this platform.", manager.getTextColor()) << "\n";
+}
+
+#else
+
+namespace {
+
+volatile sig_atomic_t interrupted = 0;
+
+void onInterrupt(int) {
+    interrupted = 1;
+}
+
+// Notifiers still running; reaped without blocking so a slow notification daemon never holds us up
+std::vector<pid_t> children;
+
+void reapChildren() {
+    children.erase(std::remove_if(children.begin(), children.end(), [](pid_t child) {
+        return waitpid(child, nullptr, WNOHANG) != 0;
+    }), children.end());
+}
+
+}
+
+bool Reminder::waitUntil(time_t deadline) {
+#ifdef __linux__
+    int timer = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+#else
+    int timer = -1;
+#endif
+    bool due = false;
+    while (!interrupted) {
+        int timeout = -1;
+        if (timer >= 0) {
+#ifdef __linux__
+            // Cancel-on-set ends the wait when the wall clock is changed, so the timer is armed
+            // again against the new time instead of firing early or late
+            itimerspec spec = {};
+            spec.it_value.tv_sec = deadline;
+            timerfd_settime(timer, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr);
+#endif
+        } else {
+            // Without a timerfd the poll timeout does the sleeping, capped so clock changes are noticed
+            time_t now = time(0);
+            if (now >= deadline) {
+                due = true;
+                break;
+            }
+            timeout = static_cast<int>(std::min<time_t>(deadline - now, 60) * 1000);
+        }
+
+        pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {timer, POLLIN, 0}};
+        int ready = poll(fds, timer >= 0 ? 2 : 1, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents != 0) break;
+        if (timer >= 0 && (fds[1].revents & POLLIN)) {
+            uint64_t expirations;
+            // A failed read is ECANCELED after a clock change; the loop arms the timer again
+            if (read(timer, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                due = true;
+                break;
+            }
+        }
+    }
+    if (timer >= 0) close(timer);
+    return due;
+}
+
+void Reminder::notifyDesktop(const std::string& summary) {
+    if (summary.empty()) return;
+    reapChildren();
+#ifdef __APPLE__
+    std::string escaped;
+    for (char c : summary) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    std::string program = "osascript";
+    std::string flag = "-e";
+    std::string script = "display notification \"" + escaped + "\" with title \"Terminal Calendar\"";
+    char* argv[] = {&program[0], &flag[0], &script[0], nullptr};
+#else
+    if (!std::getenv("DISPLAY") && !std::getenv("WAYLAND_DISPLAY")) return;
+    std::string program = "notify-send";
+    std::string title = "Terminal Calendar";
+    std::string body = summary;
+    char* argv[] = {&program[0], &title[0], &body[0], nullptr};
+#endif
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], &actions, nullptr, argv, environ) == 0) {
+        children.push_back(pid);
+    }
+    posix_spawn_file_actions_destroy(&actions);
+}
+
+void Reminder::run() {
+    std::ostream& out = manager.output();
+    interrupted = 0;
+    void (*previousHandler)(int) = std::signal(SIGINT, onInterrupt);
+
+    // Deadlines earlier in the current minute still count as due now
+    uint64_t cursor = DeadlineIndex::now() - 1;
+    out << manager.color_text("Reminders are on. Press Enter to stop.", manager.getTextColor()) << "\n";
+    while (!interrupted) {
+        uint64_t next = manager.nextDeadlineAfter(cursor);
+        if (next == 0) {
+            out << manager.color_text("No more pending deadlines to wait for.", manager.getTextColor()) << "\n";
+            break;
+        }
+        out.flush();
+        if (std::cin.rdbuf()->in_avail() > 0 || !waitUntil(static_cast<time_t>(next) * 60)) {
+            if (!interrupted) {
+                std::string line;
+                std::getline(std::cin, line);
+            }
+            break;
+        }
+        out << "\a";
+        std::string summary = manager.announceDue(next);
+        out.flush();
+        notifyDesktop(summary);
+        cursor = next;
+    }
+
+    std::signal(SIGINT, previousHandler);
+    reapChildren();
+    out << manager.color_text("Reminders stopped.", manager.getTextColor()) << "\n";
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "../include/string_arena.h"
+#include <cstring>
+
+StringArena::StringArena() : chunkUsed(CHUNK_SIZE), slots(1024), slotCount(0) {}
+
+uint32_t StringArena::hash(std::string_view text) {
+    // FNV-1a
+    uint32_t value = 2166136261u;
+    for (unsigned char c : text) {
+        value ^= c;
+        value *= 16777619u;
+    }
+    return value;
+}
+
+StringRef StringArena::store(std::string_view text) {
+    StringRef ref;
+    ref.length = static_cast<uint32_t>(text.size());
+    if (text.size() > CHUNK_SIZE) {
+        // Oversized strings get a chunk of their own
+        chunks.emplace_back(new char[text.size()]);
+        std::memcpy(chunks.back().get(), text.data(), text.size());
+        ref.offset = static_cast<uint32_t>(chunks.size() - 1) << 16;
+        chunkUsed = CHUNK_SIZE;
+        return ref;
+    }
+    if (CHUNK_SIZE - chunkUsed < text.size()) {
+        chunks.emplace_back(new char[CHUNK_SIZE]);
+        chunkUsed = 0;
+    }
+    std::memcpy(chunks.back().get() + chunkUsed, text.data(), text.size());
+    ref.offset = (static_cast<uint32_t>(chunks.size() - 1) << 16) | chunkUsed;
+    chunkUsed += static_cast<uint32_t>(text.size());
+    return ref;
+}
+
+void StringArena::grow() {
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (!slot.used) continue;
+        size_t index = slot.hash & mask;
+        while (slots[index].used) {
+            index = (index + 1) & mask;
+        }
+        slots[index] = slot;
+    }
+}
+
+StringRef StringArena::intern(std::string_view text) {
+    if (text.empty()) {
+        return StringRef();
+    }
+    uint32_t value = hash(text);
+    size_t mask = slots.size() - 1;
+    size_t index = value & mask;
+    while (slots[index].used) {
+        const Slot& slot = slots[index];
+        if (slot.hash == value && view(slot.ref) == text) {
+            return slot.ref;
+        }
+        index = (index + 1) & mask;
+    }
+    StringRef ref = store(text);
+    slots[index] = Slot{value, ref, true};
+    if (++slotCount * 2 > slots.size()) {
+        grow();
+    }
+    return ref;
+}
+
+std::string_view StringArena::view(StringRef ref) const {
+    if (ref.length == 0) {
+        return std::string_view();
+    }
+    return std::string_view(chunks[ref.offset >> 16].get() + (ref.offset & 0xFFFF), ref.length);
+}
+
+void StringArena::clear() {
+    chunks.clear();
+    chunkUsed = CHUNK_SIZE;
+    slots.assign(1024, Slot{0, StringRef(), false});
+    slotCount = 0;
+}
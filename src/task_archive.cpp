@@ -0,0 +1,298 @@
+#include "../include/task_archive.h"
+#include "../include/perf_stats.h"
+#include "../include/atomic_writer.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <zlib.h>
+
+namespace {
+
+const char HEADER_MAGIC[8] = {'T', 'C', 'A', 'R', 'C', 'H', 'V', '1'};
+const char FOOTER_MAGIC[4] = {'T', 'C', 'A', 'I'};
+// Footer: index offset (8), block count (4), magic (4)
+const size_t FOOTER_SIZE = 16;
+// Index entry: month, offset, compressed size, raw size, task count, max id
+const size_t ENTRY_SIZE = 28;
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+void putU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+uint32_t getU32(const char* data) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    return value;
+}
+
+uint64_t getU64(const char* data) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    return value;
+}
+
+// Task count and highest id of a block of task lines
+void summarize(std::string_view lines, uint32_t& count, int32_t& maxId) {
+    count = 0;
+    maxId = 0;
+    while (!lines.empty()) {
+        size_t end = lines.find('\n');
+        std::string_view line = lines.substr(0, end);
+        lines = end == std::string_view::npos ? std::string_view() : lines.substr(end + 1);
+        int id;
+        if (std::from_chars(line.data(), line.data() + line.size(), id).ec == std::errc()) {
+            count++;
+            maxId = std::max(maxId, static_cast<int32_t>(id));
+        }
+    }
+}
+
+// Ids at the start of each task line, sorted
+std::vector<int> lineIds(std::string_view lines) {
+    std::vector<int> ids;
+    while (!lines.empty()) {
+        size_t end = lines.find('\n');
+        std::string_view line = lines.substr(0, end);
+        lines = end == std::string_view::npos ? std::string_view() : lines.substr(end + 1);
+        int id;
+        if (std::from_chars(line.data(), line.data() + line.size(), id).ec == std::errc()) ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Appends the lines whose id is not in sortedIds to kept
+void keepLinesWithout(std::string_view lines, const std::vector<int>& sortedIds, std::string& kept) {
+    kept.reserve(kept.size() + lines.size());
+    while (!lines.empty()) {
+        size_t end = lines.find('\n');
+        std::string_view line = lines.substr(0, end == std::string_view::npos ? lines.size() : end + 1);
+        lines.remove_prefix(line.size());
+        int lineId;
+        if (std::from_chars(line.data(), line.data() + line.size(), lineId).ec == std::errc()
+            && std::binary_search(sortedIds.begin(), sortedIds.end(), lineId)) continue;
+        kept += line;
+    }
+}
+
+}
+
+void TaskArchive::setPath(const std::string& archivePath) {
+    path = archivePath;
+    index.clear();
+}
+
+const std::string& TaskArchive::getPath() const {
+    return path;
+}
+
+bool TaskArchive::open() {
+    index.clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return true;
+    PerfStats::increment(PerfStats::FILE_OPENS);
+
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    if (size < static_cast<std::streamoff>(sizeof(HEADER_MAGIC) + FOOTER_SIZE)) {
+        std::cerr << "Error: Task archive " << path << " is truncated." << std::endl;
+        return false;
+    }
+    char footer[FOOTER_SIZE];
+    file.seekg(size - static_cast<std::streamoff>(FOOTER_SIZE));
+    file.read(footer, FOOTER_SIZE);
+    uint64_t indexOffset = getU64(footer);
+    uint32_t count = getU32(footer + 8);
+    if (!std::equal(FOOTER_MAGIC, FOOTER_MAGIC + 4, footer + 12)
+        || indexOffset + static_cast<uint64_t>(count) * ENTRY_SIZE + FOOTER_SIZE != static_cast<uint64_t>(size)) {
+        std::cerr << "Error: Task archive " << path << " has a damaged index." << std::endl;
+        return false;
+    }
+
+    std::string entries(count * ENTRY_SIZE, '\0');
+    file.seekg(static_cast<std::streamoff>(indexOffset));
+    file.read(&entries[0], static_cast<std::streamsize>(entries.size()));
+    index.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const char* entry = entries.data() + i * ENTRY_SIZE;
+        index.push_back({getU32(entry), getU64(entry + 4), getU32(entry + 12), getU32(entry + 16),
+                         getU32(entry + 20), static_cast<int32_t>(getU32(entry + 24))});
+    }
+    return true;
+}
+
+bool TaskArchive::empty() const {
+    return index.empty();
+}
+
+size_t TaskArchive::taskCount() const {
+    size_t total = 0;
+    for (const Block& block : index) total += block.taskCount;
+    return total;
+}
+
+int TaskArchive::maxId() const {
+    int highest = 0;
+    for (const Block& block : index) highest = std::max(highest, static_cast<int>(block.maxId));
+    return highest;
+}
+
+const TaskArchive::Block* TaskArchive::find(uint32_t month) const {
+    auto it = std::lower_bound(index.begin(), index.end(), month, [](const Block& block, uint32_t key) {
+        return block.month < key;
+    });
+    return it != index.end() && it->month == month ? &*it : nullptr;
+}
+
+bool TaskArchive::contains(uint32_t month) const {
+    return find(month) != nullptr;
+}
+
+std::vector<uint32_t> TaskArchive::months() const {
+    std::vector<uint32_t> result;
+    result.reserve(index.size());
+    for (const Block& block : index) result.push_back(block.month);
+    return result;
+}
+
+bool TaskArchive::readMonth(uint32_t month, std::string& lines) const {
+    const Block* block = find(month);
+    if (!block) return true;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Could not open task archive " << path << "." << std::endl;
+        return false;
+    }
+    PerfStats::increment(PerfStats::FILE_OPENS);
+    std::string compressed(block->compressedSize, '\0');
+    file.seekg(static_cast<std::streamoff>(block->offset));
+    file.read(&compressed[0], static_cast<std::streamsize>(compressed.size()));
+
+    size_t start = lines.size();
+    lines.resize(start + block->rawSize);
+    uLongf rawSize = block->rawSize;
+    if (!file || uncompress(reinterpret_cast<Bytef*>(&lines[start]), &rawSize,
+                            reinterpret_cast<const Bytef*>(compressed.data()), compressed.size()) != Z_OK
+        || rawSize != block->rawSize) {
+        lines.resize(start);
+        std::cerr << "Error: Task archive " << path << " has a damaged block." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TaskArchive::append(const std::map<uint32_t, std::string>& linesByMonth) {
+    std::map<uint32_t, std::string> merged;
+    for (const auto& [month, lines] : linesByMonth) {
+        std::string existing;
+        if (!readMonth(month, existing)) return false;
+        // A task archived again (its segment was not rewritten before a crash) replaces its old
+        // line instead of being stored twice
+        std::string& contents = merged[month];
+        keepLinesWithout(existing, lineIds(lines), contents);
+        contents += lines;
+    }
+    return rewrite(merged);
+}
+
+bool TaskArchive::removeTasks(const std::map<uint32_t, std::vector<int>>& idsByMonth) {
+    std::map<uint32_t, std::string> replaced;
+    for (const auto& [month, ids] : idsByMonth) {
+        std::string lines;
+        if (!contains(month) || !readMonth(month, lines)) continue;
+
+        std::vector<int> sortedIds = ids;
+        std::sort(sortedIds.begin(), sortedIds.end());
+        keepLinesWithout(lines, sortedIds, replaced[month]);
+    }
+    return replaced.empty() || rewrite(replaced);
+}
+
+void TaskArchive::clear() {
+    index.clear();
+    std::remove(path.c_str());
+}
+
+bool TaskArchive::rewrite(const std::map<uint32_t, std::string>& replaced) {
+    std::ifstream oldFile;
+    if (!index.empty()) {
+        oldFile.open(path, std::ios::binary);
+        PerfStats::increment(PerfStats::FILE_OPENS);
+    }
+
+    // Blocks are compressed, so the whole archive is assembled in memory and committed at once
+    std::string data(HEADER_MAGIC, sizeof(HEADER_MAGIC));
+    std::vector<Block> newIndex;
+    auto writeReplaced = [&](uint32_t month, const std::string& lines) {
+        if (lines.empty()) return true;
+        uLongf compressedSize = compressBound(lines.size());
+        std::string compressed(compressedSize, '\0');
+        if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressedSize,
+                      reinterpret_cast<const Bytef*>(lines.data()), lines.size(), Z_BEST_COMPRESSION) != Z_OK) {
+            return false;
+        }
+        Block block = {month, data.size(), static_cast<uint32_t>(compressedSize), static_cast<uint32_t>(lines.size()), 0, 0};
+        summarize(lines, block.taskCount, block.maxId);
+        data.append(compressed.data(), compressedSize);
+        newIndex.push_back(block);
+        return true;
+    };
+    auto copyExisting = [&](const Block& old) {
+        Block block = old;
+        block.offset = data.size();
+        data.resize(data.size() + old.compressedSize);
+        oldFile.seekg(static_cast<std::streamoff>(old.offset));
+        oldFile.read(&data[block.offset], static_cast<std::streamsize>(old.compressedSize));
+        if (!oldFile) return false;
+        newIndex.push_back(block);
+        return true;
+    };
+
+    // Both the old index and the replacements are sorted by month, so merge them in one pass
+    bool ok = true;
+    auto oldIt = index.begin();
+    auto newIt = replaced.begin();
+    while (ok && (oldIt != index.end() || newIt != replaced.end())) {
+        if (newIt == replaced.end() || (oldIt != index.end() && oldIt->month < newIt->first)) {
+            ok = copyExisting(*oldIt++);
+        } else {
+            if (oldIt != index.end() && oldIt->month == newIt->first) ++oldIt;
+            ok = writeReplaced(newIt->first, newIt->second);
+            ++newIt;
+        }
+    }
+    oldFile.close();
+    if (!ok) {
+        std::cerr << "Error: Could not rebuild task archive " << path << "." << std::endl;
+        return false;
+    }
+
+    uint64_t indexOffset = data.size();
+    for (const Block& block : newIndex) {
+        putU32(data, block.month);
+        putU64(data, block.offset);
+        putU32(data, block.compressedSize);
+        putU32(data, block.rawSize);
+        putU32(data, block.taskCount);
+        putU32(data, static_cast<uint32_t>(block.maxId));
+    }
+    putU64(data, indexOffset);
+    putU32(data, static_cast<uint32_t>(newIndex.size()));
+    data.append(FOOTER_MAGIC, sizeof(FOOTER_MAGIC));
+
+    if (newIndex.empty()) {
+        std::remove(path.c_str());
+    } else if (!AtomicWriter::commit(path, data)) {
+        return false;
+    }
+    index.swap(newIndex);
+    return true;
+}
@@ -1,4 +1,9 @@
 #include "../include/task_manager.h"
+#include "../include/perf_stats.h"
+#include "../include/banner_font.h"
+#include "../include/display_width.h"
+#include "../include/atomic_writer.h"
+#include "../include/time_zone.h"
 #include <map>
 #include <iostream>
 #include <iomanip>
@@ -6,12 +11,25 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include <codecvt>
-#include <sys/select.h>
+#include <cctype>
+#include <charconv>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#ifdef _WIN32
+#ifndef STDOUT_FILENO
+#define STDOUT_FILENO 1
+#endif
+#else
+#include <sys/ioctl.h>
 #include <unistd.h>
+#endif
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
@@ -27,7 +45,7 @@ int TaskManager::CALENDAR_BORDER_BOLD;
 int TaskManager::TEXT_BOLD;
 int TaskManager::EVENT_DISPLAY;
 json TaskManager::configFile;
-int TaskManager::CALENDAR_HEIGHT;
+int TaskManager::ARCHIVE_AFTER_DAYS;
 
 static const std::unordered_map<std::string, std::string> colorCodes = {
         {"BLACK", "\033[30m"}, {"RED", "\033[31m"}, {"GREEN", "\033[32m"},
@@ -40,17 +58,73 @@ static const std::unordered_map<std::string, std::string> colorCodes = {
         {"BOLD_CYAN", "\033[1;36m"}, {"BOLD_WHITE", "\033[1;37m"}
     };
 
-TaskManager::TaskManager(const std::string& file) : filename(file), nextId(1) {
+// Calendars beyond the primary one cycle through these unless CALENDAR_COLORS names a color
+static const char* const CALENDAR_PALETTE[] = {"CYAN", "MAGENTA", "YELLOW", "GREEN", "BLUE", "RED"};
+
+// Days since the epoch of a packed date
+static int64_t dayNumber(uint32_t date) {
+    return CivilDate::daysFromCivil(TaskStore::yearOf(date), TaskStore::monthOf(date), TaskStore::dayOf(date));
+}
+
+// UTC year at the start (or end) of a local day, which is the segment of deadlines at that time
+static int segmentYearOfDay(int64_t day, bool end) {
+    return TimeZone::toCivil(TimeZone::local().toUtc(day * 24 * 60 * 60 + (end ? 24 * 60 * 60 - 1 : 0))).year;
+}
+
+struct TaskManager::ParsedTask {
+    int id;
+    uint32_t date;
+    std::string_view description;
+    // Deadline in UTC and as local wall time, both in minutes since the epoch
+    int64_t instant;
+    int64_t localMinute;
+    uint16_t zone;
+    bool completed;
+    std::string_view tags;
+    TaskStore::Priority priority;
+};
+
+TaskManager::TaskManager(const std::string& file, OutputSink* outputSink)
+    : TaskManager(std::vector<CalendarSource>{{fs::path(file).stem().string(), file}}, outputSink) {
+}
+
+TaskManager::TaskManager(const std::vector<CalendarSource>& sources, OutputSink* outputSink)
+    : calendars(sources.size()), stdoutSink(STDOUT_FILENO),
+      sink(outputSink ? outputSink : &stdoutSink), sinkBuf(sink), out(&sinkBuf),
+      bannerYear(0), bannerMonth(0), bannerCellWidth(0) {
     loadConfigs();
+    json calendarColors = configFile.value("CALENDAR_COLORS", json::object());
+    for (size_t i = 0; i < sources.size(); i++) {
+        calendars[i].name = sources[i].name;
+        calendars[i].filename = sources[i].filename;
+        if (calendarColors.is_object() && calendarColors.contains(sources[i].name) && calendarColors[sources[i].name].is_string()) {
+            calendars[i].color = calendarColors[sources[i].name].get<std::string>();
+        } else if (i > 0) {
+            calendars[i].color = CALENDAR_PALETTE[(i - 1) % (sizeof(CALENDAR_PALETTE) / sizeof(CALENDAR_PALETTE[0]))];
+        }
+    }
     loadTasks();
-    CALENDAR_HEIGHT = calculateCalendarHeight();
 }
 
+void TaskManager::setOutputSink(OutputSink* outputSink) {
+    out.flush();
+    sink = outputSink ? outputSink : &stdoutSink;
+    sinkBuf.setSink(sink);
+}
+
+OutputSink& TaskManager::getOutputSink() {
+    return *sink;
+}
 
-std::string TaskManager::color_text(const std::string& text, const std::string& color, const int bold) {
+std::ostream& TaskManager::output() {
+    return out;
+}
+
+
+std::string TaskManager::color_text(std::string_view text, const std::string& color, const int bold) {
     auto it = colorCodes.find(color);
     if (it == colorCodes.end()) {
-        return text;
+        return std::string(text);
     }
     std::string result;
     if (bold == 1) {
@@ -68,33 +142,35 @@ std::string TaskManager::color_text(const std::string& text, const std::string&
 }
 
 void TaskManager::clearScreen() {
-    std::cout << "\033[2J\033[3J\033[H";
+    out << "\033[2J\033[3J\033[H";
 }
 
 void TaskManager::moveCursor(int row, int col) {
-    std::cout << "\033[" << row << ";" << col << "H";
+    out << "\033[" << row << ";" << col << "H";
 }
 
 void TaskManager::saveCursor() {
-    std::cout << "\033[s";
+    out << "\033[s";
 }
 
 void TaskManager::restoreCursor() {
-    std::cout << "\033[u";
+    out << "\033[u";
 }
 
 void TaskManager::clearLine() {
-    std::cout << "\033[2K";
+    out << "\033[2K";
 }
 
 void TaskManager::clearFromCursor() {
-    std::cout << "\033[J";
+    out << "\033[J";
 }
 
 int TaskManager::calculateCalendarHeight() {
-	// 8 lines of buffer (6 for the month and 2 for the days of the week)
-	// Use cell height + 1 (for the calendar border character) * 6 (max number of weeks per month)
-    return 8 + (6 * (CELL_HEIGHT + 1));
+    return calendarLayout().height;
+}
+
+const CalendarLayout& TaskManager::calendarLayout() {
+    return CalendarLayout::current(TaskManager::CELL_WIDTH, TaskManager::CELL_HEIGHT);
 }
 
 std::string TaskManager::getExecutableDirectory(){
@@ -123,8 +199,10 @@ std::string TaskManager::getExecutableDirectory(){
 }
 
 void TaskManager::loadConfigs(){
+    PerfStats::ScopedTimer timer(PerfStats::CONFIG_READ);
     std::string executableDirectory = getExecutableDirectory();
     std::string configPath = executableDirectory + "/config.json";
+    PerfStats::increment(PerfStats::FILE_OPENS);
     std::ifstream file(configPath); 
     if (!file){
         std::cerr << "Could not open the config file" << std::endl;
@@ -132,8 +210,9 @@ void TaskManager::loadConfigs(){
     }
     file >> TaskManager::configFile;
     try {
-        TaskManager::CELL_WIDTH = configFile.value("CELL_WIDTH", 28);
-        TaskManager::CELL_HEIGHT = configFile.value("CELL_HEIGHT", 10);
+        // Upper bounds; the calendar shrinks below them to fit the terminal
+        TaskManager::CELL_WIDTH = configFile.value("CELL_WIDTH", CalendarLayout::MAX_CELL_WIDTH);
+        TaskManager::CELL_HEIGHT = configFile.value("CELL_HEIGHT", CalendarLayout::MAX_CELL_HEIGHT);
         TaskManager::ICS_VALUE = configFile.value("ICS_VALUE", 1);
         TaskManager::CALENDAR_BORDER_COLOR = configFile.value("CALENDAR_BORDER_COLOR", "WHITE");
         TaskManager::TEXT_COLOR = configFile.value("TEXT_COLOR", "WHITE");
@@ -141,6 +220,13 @@ void TaskManager::loadConfigs(){
         TaskManager::CALENDAR_BORDER_BOLD = configFile.value("CALENDAR_BORDER_BOLD", 0);
         TaskManager::TEXT_BOLD = configFile.value("TEXT_BOLD", 0);
         TaskManager::EVENT_DISPLAY = configFile.value("EVENT_DISPLAY",1);
+        TaskManager::ARCHIVE_AFTER_DAYS = configFile.value("ARCHIVE_AFTER_DAYS", 90);
+        AtomicWriter::Durability durability;
+        if (!AtomicWriter::parseDurability(configFile.value("DURABILITY", "SYNC"), durability)) {
+            std::cerr << "Invalid DURABILITY in config.json, expected SYNC, GROUP or OS. Using SYNC." << std::endl;
+            durability = AtomicWriter::Durability::SYNC;
+        }
+        AtomicWriter::setPolicy(durability, std::chrono::milliseconds(std::max(configFile.value("GROUP_COMMIT_MS", 100), 1)));
         std::string sortingMethod = configFile.value("SORTING_METHOD", "ID");
         if (sortingMethod.compare("ID") == 0){
             TaskManager::SORT_METHOD = "By ID";
@@ -155,64 +241,449 @@ void TaskManager::loadConfigs(){
         std::cerr << "Error parsing config.json: " << e.what() << std::endl;
     }
 }
+
+bool TaskManager::readConfigFile(){
+    PerfStats::ScopedTimer timer(PerfStats::CONFIG_READ);
+    PerfStats::increment(PerfStats::FILE_OPENS);
+    std::ifstream file(getExecutableDirectory() + "/config.json");
+    if (!file){
+        std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
+        return false;
+    }
+    file >> TaskManager::configFile;
+    return true;
+}
+
+void TaskManager::writeConfigFile(){
+    PerfStats::ScopedTimer timer(PerfStats::CONFIG_WRITE);
+    AtomicWriter::commit(getExecutableDirectory() + "/config.json", TaskManager::configFile.dump(4));
+}
 void TaskManager::loadTasks() {
-    std::ifstream inFile(filename);
-    if (!inFile) {
-        std::cout << color_text("No existing task file found. Creating a new one.", TaskManager::TEXT_COLOR) << std::endl;
-        return;
+    PerfStats::ScopedTimer timer(PerfStats::LOAD_TASKS);
+    store.clear();
+
+    // Each file is read whole and split into views on its own thread; only the merge into the
+    // store, which interns the strings, runs here
+    std::vector<std::string> contents(calendars.size());
+    std::vector<std::vector<ParsedTask>> parsed(calendars.size());
+    std::vector<TaskSegments::Layout> layouts(calendars.size());
+    int currentYear = TimeZone::toCivil(std::time(nullptr)).year;
+    auto readAndParse = [&](size_t i) {
+        Calendar& calendar = calendars[i];
+        layouts[i] = calendar.segments.open(contents[i]);
+        if (layouts[i] == TaskSegments::Layout::SEGMENTED) {
+            // Only this year's segment is read up front, plus any the manifest cannot vouch for
+            for (const TaskSegments::Segment& segment : calendar.segments.segments()) {
+                if (segment.year == currentYear || segment.stale) {
+                    calendar.loadedYears.insert(segment.year);
+                    calendar.segments.readYear(segment.year, contents[i]);
+                }
+            }
+        }
+        parseTaskLines(contents[i], parsed[i]);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < calendars.size(); i++) {
+        Calendar& calendar = calendars[i];
+        calendar.segments.setPath(calendar.filename);
+        calendar.loadedYears.clear();
+        calendar.dirtyYears.clear();
+        calendar.loadedArchiveMonths.clear();
+        // Only the archive index is read here; its blocks load when a view reaches into the past
+        calendar.archive.setPath(calendar.filename + ".archive");
+        calendar.archive.open();
+        calendar.nextId = std::max(calendar.nextId, calendar.archive.maxId() + 1);
+        if (calendars.size() > 1) {
+            workers.emplace_back(readAndParse, i);
+        } else {
+            readAndParse(i);
+        }
     }
-    
-    tasks.clear();
-    taskList.clear();
-    std::string line;
-    
-    while (std::getline(inFile, line)) {
-        std::istringstream iss(line);
-        Task task;
-        char delimiter;
-        
-        iss >> task.id >> delimiter;
-        if (delimiter != '|') continue;
-        
-        std::getline(iss, task.description, '|');
-        std::getline(iss, task.deadline, '|');
-        int month = getMonthOfTask(task.deadline);       
-        int completed;
-        iss >> completed;
-        task.completed = completed == 1;
-        task.day = getDayOfTask(task.deadline);
-        task.year = getYearOfTask(task.deadline);
-        task.month = month;
-        tasks[month].push_back(task);
-        taskList.push_back(task);
-        
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (size_t i = 0; i < calendars.size(); i++) {
+        if (layouts[i] == TaskSegments::Layout::MISSING) {
+            std::string name = calendars.size() > 1 ? " for calendar " + calendars[i].name : "";
+            out << color_text("No existing task file found" + name + ". Creating a new one.", TaskManager::TEXT_COLOR) << "\n";
+            continue;
+        }
+        calendars[i].singleFile = layouts[i] == TaskSegments::Layout::SINGLE_FILE;
+        calendars[i].nextId = std::max(calendars[i].nextId, calendars[i].segments.maxId() + 1);
+        mergeTasks(static_cast<uint8_t>(i), parsed[i], false);
+    }
+    if (calendars.size() > 1) resortStore();
+}
+
+// Splits task lines into views of content without touching any shared state
+void TaskManager::parseTaskLines(std::string_view remaining, std::vector<ParsedTask>& tasks) {
+    // Task lines rarely run shorter than 32 bytes
+    tasks.reserve(tasks.size() + remaining.size() / 32);
+    const TimeZone& local = TimeZone::local();
+    std::string_view lastZoneName;
+    uint16_t lastZone = 0;
+    while (!remaining.empty()) {
+        size_t end = remaining.find('\n');
+        std::string_view line = remaining.substr(0, end);
+        remaining = end == std::string_view::npos ? std::string_view() : remaining.substr(end + 1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+        size_t first = line.find('|');
+        size_t second = first == std::string_view::npos ? first : line.find('|', first + 1);
+        size_t third = second == std::string_view::npos ? second : line.find('|', second + 1);
+        if (third == std::string_view::npos) continue;
+
+        int id;
+        std::string_view idField = line.substr(0, first);
+        while (!idField.empty() && idField.front() == ' ') idField.remove_prefix(1);
+        if (std::from_chars(idField.data(), idField.data() + idField.size(), id).ec != std::errc()) continue;
+
+        std::string_view description = line.substr(first + 1, second - first - 1);
+        std::string_view deadline = line.substr(second + 1, third - second - 1);
+        // "YYYY-MM-DDTHH:MMZ[ zone]" is UTC; older files hold local wall times
+        int64_t seconds;
+        if (!TimeZone::parseWallTime(deadline, seconds)) continue;
+        uint16_t zone = 0;
+        if (deadline.size() >= 17 && deadline[16] == 'Z') {
+            if (deadline.size() > 18 && deadline[17] == ' ') {
+                std::string_view zoneName = deadline.substr(18);
+                if (zoneName != lastZoneName) {
+                    const TimeZone* found = TimeZone::find(zoneName);
+                    lastZoneName = zoneName;
+                    lastZone = found ? found->id() : 0;
+                }
+                zone = lastZone;
+            }
+        } else {
+            seconds = local.toUtc(seconds);
+        }
+        int64_t localSeconds = local.toLocal(seconds);
+        CivilTime wall = TimeZone::toCivil(localSeconds);
+
+        bool completed = line.substr(third + 1, 1) == "1";
+        // Tags and the priority are optional trailing fields, so files without them read as before
+        size_t fourth = line.find('|', third + 1);
+        size_t fifth = fourth == std::string_view::npos ? fourth : line.find('|', fourth + 1);
+        std::string_view tags = fourth == std::string_view::npos ? std::string_view() : line.substr(fourth + 1, fifth - fourth - 1);
+        TaskStore::Priority priority = TaskStore::NONE;
+        if (fifth != std::string_view::npos && fifth + 1 < line.size() && line[fifth + 1] >= '1' && line[fifth + 1] <= '3') {
+            priority = static_cast<TaskStore::Priority>(line[fifth + 1] - '0');
+        }
+        tasks.push_back({id, TaskStore::packDate(wall.year, wall.month, wall.day), description, seconds / 60, localSeconds / 60, zone,
+                         completed, tags, priority});
+    }
+}
+
+// A crash between archiving a task and rewriting its year leaves it in both files. The archived
+// copy wins whichever side loads first: a year row whose id is already archived is skipped, a
+// loaded year row is dropped when its archived copy arrives, and in both cases the year is marked
+// dirty so the next save writes it without the task.
+size_t TaskManager::mergeTasks(uint8_t calendar, const std::vector<ParsedTask>& tasks, bool archived) {
+    Calendar& owner = calendars[calendar];
+    int& nextId = owner.nextId;
+    std::unordered_map<int, uint32_t> otherSide;
+    for (size_t row = 0; row < store.size(); row++) {
+        if (store.calendar(row) == calendar && store.archived(row) != archived) otherSide.emplace(store.id(row), static_cast<uint32_t>(row));
+    }
+    std::vector<uint32_t> duplicates;
+    size_t added = 0;
+    char deadline[16];
+    for (const ParsedTask& task : tasks) {
+        auto duplicate = otherSide.find(task.id);
+        if (duplicate != otherSide.end()) {
+            if (!archived) {
+                owner.dirtyYears.insert(TimeZone::toCivil(task.instant * 60).year);
+                continue;
+            }
+            markDirty(duplicate->second);
+            duplicates.push_back(duplicate->second);
+            otherSide.erase(duplicate);
+        }
+        added++;
+        size_t length = TimeZone::formatWallTime(task.localMinute * 60, ' ', deadline);
+        size_t row = store.add(task.id, task.date, task.description, std::string_view(deadline, length), task.instant, task.completed,
+                               calendar, task.tags, task.priority, task.zone);
+        if (archived) store.setArchived(row);
         if (task.id >= nextId) {
             nextId = task.id + 1;
         }
     }
-    
-    inFile.close();
+    // The new rows were appended after every duplicate, so the indices still hold
+    std::sort(duplicates.begin(), duplicates.end());
+    store.removeRows(duplicates);
+    PerfStats::increment(PerfStats::TASKS_PARSED, tasks.size());
+    return added + duplicates.size();
 }
 
-void TaskManager::saveTasks() {
-    std::ofstream outFile(filename);
-    for (int i = 1; i < 13; i++){
-        if (!tasks[i].empty()){
-            for (const auto& task : tasks[i]) {
-                outFile << task.id << "|" << task.description << "|" 
-                        << task.deadline << "|" << (task.completed ? 1 : 0) << std::endl;
+void TaskManager::loadYearsWhere(const std::function<bool(size_t, const TaskSegments::Segment&)>& wanted) {
+    size_t merged = 0;
+    for (size_t i = 0; i < calendars.size(); i++) {
+        Calendar& calendar = calendars[i];
+        std::string lines;
+        for (const TaskSegments::Segment& segment : calendar.segments.segments()) {
+            if (!calendar.loadedYears.count(segment.year) && wanted(i, segment)) {
+                calendar.loadedYears.insert(segment.year);
+                calendar.segments.readYear(segment.year, lines);
             }
         }
+        if (lines.empty()) continue;
+        PerfStats::ScopedTimer timer(PerfStats::LOAD_SEGMENT);
+        std::vector<ParsedTask> tasks;
+        parseTaskLines(lines, tasks);
+        merged += mergeTasks(static_cast<uint8_t>(i), tasks, false);
+    }
+    if (merged > 0) resortStore();
+}
+
+void TaskManager::loadDays(int64_t firstDay, int64_t lastDay) {
+    int firstYear = segmentYearOfDay(firstDay, false);
+    int lastYear = segmentYearOfDay(lastDay, true);
+    loadYearsWhere([&](size_t, const TaskSegments::Segment& segment) {
+        return segment.year >= firstYear && segment.year <= lastYear;
+    });
+}
+
+void TaskManager::loadPendingYears() {
+    loadYearsWhere([](size_t, const TaskSegments::Segment& segment) {
+        return segment.pendingCount > 0;
+    });
+}
+
+void TaskManager::loadAllYears() {
+    loadYearsWhere([](size_t, const TaskSegments::Segment&) {
+        return true;
+    });
+}
+
+void TaskManager::loadSelected(const TaskSelector& selector) {
+    int firstYear = INT_MIN;
+    int lastYear = INT_MAX;
+    if (selector.onDate != 0) {
+        firstYear = segmentYearOfDay(dayNumber(selector.onDate), false);
+        lastYear = segmentYearOfDay(dayNumber(selector.onDate), true);
+    } else if (selector.before != 0) {
+        lastYear = segmentYearOfDay(dayNumber(selector.before), false);
+    }
+    loadYearsWhere([&](size_t calendar, const TaskSegments::Segment& segment) {
+        if (selector.calendar >= 0 && static_cast<size_t>(selector.calendar) != calendar) return false;
+        if (selector.pendingOnly && segment.pendingCount == 0) return false;
+        if (selector.completedOnly && segment.pendingCount == segment.taskCount) return false;
+        return segment.year >= firstYear && segment.year <= lastYear && segment.minId <= selector.lastId && segment.maxId >= selector.firstId;
+    });
+}
+
+void TaskManager::loadListed(bool all) {
+    if (all) {
+        loadAllYears();
+        loadArchive();
+    } else {
+        loadPendingYears();
+    }
+}
+
+void TaskManager::loadMonth(int year, int month) {
+    loadDays(CivilDate::daysFromCivil(year, month, 1), CivilDate::daysFromCivil(year, month, CivilDate::daysInMonth(year, month)));
+    loadArchivedMonth(year, month);
+}
+
+void TaskManager::loadArchivedMonth(int year, int month) {
+    loadArchivedMonths({TaskStore::packDate(year, month, 0) >> 5});
+}
+
+void TaskManager::loadArchive() {
+    std::set<uint32_t> months;
+    for (const Calendar& calendar : calendars) {
+        std::vector<uint32_t> calendarMonths = calendar.archive.months();
+        months.insert(calendarMonths.begin(), calendarMonths.end());
+    }
+    loadArchivedMonths(std::vector<uint32_t>(months.begin(), months.end()));
+}
+
+// Merges the given archive months of every calendar into the store, reading each block once and
+// re-sorting once
+void TaskManager::loadArchivedMonths(const std::vector<uint32_t>& months) {
+    size_t merged = 0;
+    for (size_t i = 0; i < calendars.size(); i++) {
+        Calendar& calendar = calendars[i];
+        std::string lines;
+        for (uint32_t key : months) {
+            if (calendar.archive.contains(key) && calendar.loadedArchiveMonths.insert(key).second) {
+                calendar.archive.readMonth(key, lines);
+            }
+        }
+        if (lines.empty()) continue;
+        PerfStats::ScopedTimer timer(PerfStats::LOAD_ARCHIVE);
+        std::vector<ParsedTask> tasks;
+        parseTaskLines(lines, tasks);
+        merged += mergeTasks(static_cast<uint8_t>(i), tasks, true);
+    }
+    if (merged > 0) resortStore();
+}
+
+// Re-applies the configured order after archived rows were appended
+void TaskManager::resortStore() {
+    PerfStats::ScopedTimer timer(PerfStats::SORT_TASKS);
+    std::string sortMethod = configFile.value("EVENT_SORT", "ID");
+    if (sortMethod == "ASCENDING") {
+        store.sortByDate(true);
+    } else if (sortMethod == "DESCENDING") {
+        store.sortByDate(false);
+    } else {
+        store.sortById();
+    }
+}
+
+// Finds a task by id, loading the segments whose id range covers it and falling back to the
+// calendar's archive for ids that are not active
+size_t TaskManager::findTask(int id, uint8_t calendar) {
+    size_t row = store.find(id, calendar);
+    if (row == TaskStore::npos) {
+        // The manifest's id ranges tell which segments can hold it
+        loadYearsWhere([&](size_t i, const TaskSegments::Segment& segment) {
+            return i == calendar && id >= segment.minId && id <= segment.maxId;
+        });
+        row = store.find(id, calendar);
+    }
+    const TaskArchive& archive = calendars[calendar].archive;
+    if (row == TaskStore::npos && !archive.empty() && id <= archive.maxId()) {
+        loadArchivedMonths(archive.months());
+        row = store.find(id, calendar);
+    }
+    return row;
+}
+
+int TaskManager::segmentYear(size_t row) const {
+    return TimeZone::toCivil(store.instant(row) * 60).year;
+}
+
+void TaskManager::markDirty(size_t row) {
+    // Archived rows live in the archive, not in a segment
+    if (store.archived(row)) return;
+    calendars[store.calendar(row)].dirtyYears.insert(segmentYear(row));
+}
+
+const std::string& TaskManager::calendarColor(uint8_t calendar) const {
+    const std::string& color = calendars[calendar].color;
+    return color.empty() ? TaskManager::EVENTS_COLOR : color;
+}
+
+std::string TaskManager::taskLabel(int id, uint8_t calendar) const {
+    if (calendars.size() == 1) return std::to_string(id);
+    return calendars[calendar].name + ":" + std::to_string(id);
+}
+
+int TaskManager::findCalendar(const std::string& name) const {
+    for (size_t i = 0; i < calendars.size(); i++) {
+        if (calendars[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+size_t TaskManager::calendarCount() const {
+    return calendars.size();
+}
+
+// Moves completed tasks whose date is more than ARCHIVE_AFTER_DAYS in the past into the archive
+// of their calendar. Rows of archive months that are already loaded stay in memory flagged as
+// archived; the others are dropped, since loading that month later brings them back.
+size_t TaskManager::archiveOldTasks() {
+    if (TaskManager::ARCHIVE_AFTER_DAYS <= 0) return 0;
+    CivilTime cutoffTime = TimeZone::toCivil(TimeZone::toSeconds(TimeZone::local().now())
+                                             - static_cast<int64_t>(TaskManager::ARCHIVE_AFTER_DAYS) * 24 * 60 * 60);
+    uint32_t cutoff = TaskStore::packDate(cutoffTime.year, cutoffTime.month, cutoffTime.day);
+
+    std::vector<std::map<uint32_t, std::string>> linesByMonth(calendars.size());
+    std::vector<uint32_t> candidates;
+    for (size_t row = 0; row < store.size(); row++) {
+        if (!store.completed(row) || store.archived(row) || store.date(row) >= cutoff) continue;
+        appendTaskLine(linesByMonth[store.calendar(row)][store.date(row) >> 5], row);
+        candidates.push_back(static_cast<uint32_t>(row));
+    }
+    if (candidates.empty()) return 0;
+
+    std::vector<char> appended(calendars.size(), 0);
+    for (size_t i = 0; i < calendars.size(); i++) {
+        appended[i] = !linesByMonth[i].empty() && calendars[i].archive.append(linesByMonth[i]);
+    }
+
+    size_t moved = 0;
+    std::vector<uint32_t> dropped;
+    for (uint32_t row : candidates) {
+        if (!appended[store.calendar(row)]) continue;
+        Calendar& calendar = calendars[store.calendar(row)];
+        calendar.dirtyYears.insert(segmentYear(row));
+        moved++;
+        if (calendar.loadedArchiveMonths.count(store.date(row) >> 5)) {
+            store.setArchived(row);
+        } else {
+            dropped.push_back(row);
+        }
+    }
+    store.removeRows(dropped);
+    return moved;
+}
+
+void TaskManager::appendTaskLine(std::string& buffer, size_t row) const {
+    buffer += std::to_string(store.id(row));
+    buffer += '|';
+    buffer += store.description(row);
+    buffer += '|';
+    char deadline[16];
+    buffer.append(deadline, TimeZone::formatWallTime(store.instant(row) * 60, 'T', deadline));
+    buffer += 'Z';
+    if (const TimeZone* zone = TimeZone::byId(store.zone(row))) {
+        buffer += ' ';
+        buffer += zone->name();
+    }
+    buffer += store.completed(row) ? "|1" : "|0";
+    TaskStore::Priority priority = store.priority(row);
+    if (!store.tags(row).empty() || priority != TaskStore::NONE) {
+        buffer += '|';
+        buffer += store.tags(row);
+    }
+    if (priority != TaskStore::NONE) {
+        buffer += '|';
+        buffer += static_cast<char>('0' + priority);
+    }
+    buffer += '\n';
+}
+
+// Writes back every segment with unsaved changes. A calendar still in a single file is written
+// out as segments in full, which turns its task file into a manifest.
+void TaskManager::saveTasks() {
+    PerfStats::ScopedTimer timer(PerfStats::SAVE_TASKS);
+    archiveOldTasks();
+    std::vector<std::map<int, std::string>> linesByYear(calendars.size());
+    for (size_t i = 0; i < calendars.size(); i++) {
+        // A dirty year that ends up with no lines is dropped
+        for (int year : calendars[i].dirtyYears) linesByYear[i][year];
+    }
+    size_t written = 0;
+    for (size_t row = 0; row < store.size(); row++) {
+        const Calendar& calendar = calendars[store.calendar(row)];
+        if (store.archived(row) || calendar.dirtyYears.empty()) continue;
+        int year = segmentYear(row);
+        if (!calendar.singleFile && !calendar.dirtyYears.count(year)) continue;
+        appendTaskLine(linesByYear[store.calendar(row)][year], row);
+        written++;
+    }
+    PerfStats::increment(PerfStats::TASKS_WRITTEN, written);
+    for (size_t i = 0; i < calendars.size(); i++) {
+        Calendar& calendar = calendars[i];
+        if (calendar.dirtyYears.empty()) continue;
+        calendar.segments.write(linesByYear[i]);
+        // Years written for the first time are in the store already
+        for (const auto& year : linesByYear[i]) calendar.loadedYears.insert(year.first);
+        calendar.dirtyYears.clear();
+        calendar.singleFile = false;
     }
-    outFile.close();
 }
 
 std::string TaskManager::getCurrentDateTime() {
-    auto t = std::time(nullptr);
-    auto tm = *std::localtime(&t);
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M");
-    return oss.str();
+    char now[16];
+    return std::string(now, TimeZone::formatWallTime(TimeZone::toSeconds(TimeZone::local().now()), ' ', now));
 }
 
 bool TaskManager::isValidDateTime(const std::string& dateTime) {
@@ -243,173 +714,105 @@ bool TaskManager::isValidDateTime(const std::string& dateTime) {
     return true;
 }
 
-void TaskManager::printYearAndMonth(int year, int month){
-        std::map<int, std::vector<std::string>> monthMap = {
-        {1, {
-            "     ██╗ █████╗ ███╗   ██╗",
-            "     ██║██╔══██╗████╗  ██║",
-            "     ██║███████║██╔██╗ ██║",
-            "██   ██║██╔══██║██║╚██╗██║",
-            "╚█████╔╝██║  ██║██║ ╚████║",
-            " ╚════╝ ╚═╝  ╚═╝╚═╝  ╚═══╝"
-        }},
-        {2, {
-            " ███████╗███████╗██████╗ ",
-            " ██╔════╝██╔════╝██╔══██╗",
-            " █████╗  █████╗  ██████╔╝",
-            " ██╔══╝  ██╔══╝  ██╔══██╗",
-            " ██║     ███████╗██████╔╝",
-            " ╚═╝     ╚══════╝╚═════╝ "
-        }},
-        {3, {
-            " ███╗   ███╗ █████╗ ██████╗ ",
-            " ████╗ ████║██╔══██╗██╔══██╗",
-            " ██╔████╔██║███████║██████╔╝",
-            " ██║╚██╔╝██║██╔══██║██╔══██╗",
-            " ██║ ╚═╝ ██║██║  ██║██║  ██║",
-            " ╚═╝     ╚═╝╚═╝  ╚═╝╚═╝  ╚═╝"
-        }},
-        {4, {
-            "  █████╗ ██████╗ ██████╗ ",
-            " ██╔══██╗██╔══██╗██╔══██╗",
-            " ███████║██████╔╝██████╔╝",
-            " ██╔══██║██╔═══╝ ██╔══██╗",
-            " ██║  ██║██║     ██║  ██║",
-            " ╚═╝  ╚═╝╚═╝     ╚═╝  ╚═╝"
-        }},
-        {5, {
-            " ███╗   ███╗ █████╗ ██╗   ██╗",
-            " ████╗ ████║██╔══██╗╚██╗ ██╔╝",
-            " ██╔████╔██║███████║ ╚████╔╝ ",
-            " ██║╚██╔╝██║██╔══██║  ╚██╔╝  ",
-            " ██║ ╚═╝ ██║██║  ██║   ██║   ",
-            " ╚═╝     ╚═╝╚═╝  ╚═╝   ╚═╝   "
-        }},
-        {6, {
-            "     ██╗██╗   ██╗███╗   ██╗",
-            "     ██║██║   ██║████╗  ██║",
-            "     ██║██║   ██║██╔██╗ ██║",
-            "██   ██║██║   ██║██║╚██╗██║",
-            "╚█████╔╝╚██████╔╝██║ ╚████║",
-            " ╚════╝  ╚═════╝ ╚═╝  ╚═══╝"
-        }},
-        {7, {
-            "     ██╗██╗   ██╗██╗     ",
-            "     ██║██║   ██║██║     ",
-            "     ██║██║   ██║██║     ",
-            "██   ██║██║   ██║██║     ",
-            "╚█████╔╝╚██████╔╝███████╗",
-            " ╚════╝  ╚═════╝ ╚══════╝"
-        }},
-        {8, {
-            "  █████╗ ██╗   ██╗ ██████╗ ",
-            " ██╔══██╗██║   ██║██╔════╝ ",
-            " ███████║██║   ██║██║  ███╗",
-            " ██╔══██║██║   ██║██║   ██║",
-            " ██║  ██║╚██████╔╝╚██████╔╝",
-            " ╚═╝  ╚═╝ ╚═════╝  ╚═════╝ "
-        }},
-        {9, {
-            "███████╗███████╗██████╗ ████████╗",
-            "██╔════╝██╔════╝██╔══██╗╚══██╔══╝",
-            "███████╗█████╗  ██████╔╝   ██║   ",
-            "╚════██║██╔══╝  ██╔═══╝    ██║   ",
-            "███████║███████╗██║        ██║   ",
-            "╚══════╝╚══════╝╚═╝        ╚═╝   "
-        }},
-        {10, {
-            "  ██████╗  ██████╗████████╗",
-            " ██╔═══██╗██╔════╝╚══██╔══╝",
-            " ██║   ██║██║        ██║   ",
-            " ██║   ██║██║        ██║   ",
-            " ╚██████╔╝╚██████╗   ██║   ",
-            "  ╚═════╝  ╚═════╝   ╚═╝   "
-        }},
-        {11, {
-            " ███╗   ██╗ ██████╗ ██╗   ██╗",
-            " ████╗  ██║██╔═══██╗██║   ██║",
-            " ██╔██╗ ██║██║   ██║██║   ██║",
-            " ██║╚██╗██║██║   ██║╚██╗ ██╔╝",
-            " ██║ ╚████║╚██████╔╝ ╚████╔╝ ",
-            " ╚═╝  ╚═══╝ ╚═════╝   ╚═══╝  "
-        }},
-        {12, {
-            " ██████╗ ███████╗ ██████╗ ",
-            " ██╔══██╗██╔════╝██╔════╝ ",
-            " ██║  ██║█████╗  ██║      ",
-            " ██║  ██║██╔══╝  ██║      ",
-            " ██████╔╝███████╗╚██████╗ ",
-            " ╚═════╝ ╚══════╝ ╚═════╝ "
-        }}
-    };
-    std::map<int, std::vector<std::string>> yearMap = {
-    {2025, {
-            " ██████╗  ██████╗ ██████╗ ███████╗",
-            " ╚════██╗██╔═══██╗╚════██╗██╔════╝",
-            "  █████╔╝██║   ██║ █████╔╝███████╗",
-            " ██╔═══╝ ██║   ██║██╔═══╝ ╚════██║",
-            " ███████╗╚██████╔╝███████╗███████║",
-            " ╚══════╝ ╚═════╝ ╚══════╝╚══════╝"       
-        }},
-        {2026,{
-            " ██████╗  ██████╗ ██████╗  ██████╗ ",
-            " ╚════██╗██╔═══██╗╚════██╗██╔════╝ ",
-            "  █████╔╝██║   ██║ █████╔╝███████╗ ",
-            " ██╔═══╝ ██║   ██║██╔═══╝ ██╔═══██╗",
-            " ███████╗╚██████╔╝███████╗╚██████╔╝",
-            " ╚══════╝ ╚═════╝ ╚══════╝ ╚═════╝ "
-        }}
-    };
-    std::vector<std::string> monthASCII = monthMap[month];
-    std::vector<std::string> yearASCII = yearMap[year];
-    for (int i = 0; i < static_cast<int>(monthASCII.size()); i ++){
-        std::cout << std::string(static_cast<int>((TaskManager::getCalendarCellWidth() * 7 - count_utf8_characters_wstring(monthASCII[i]) - 3 - count_utf8_characters_wstring(yearASCII[i])) / 2), ' ') << color_text(monthASCII[i], TaskManager::TEXT_COLOR, 0) << "   " << color_text(yearASCII[i], TaskManager::TEXT_COLOR, 0) << std::endl;
+void TaskManager::printYearAndMonth(int year, int month, const CalendarLayout& layout){
+    if (sink->discards()) return;
+    if (month < 1 || month > 12) return;
+
+    int cellWidth = layout.cellWidth;
+    if (year != bannerYear || month != bannerMonth || cellWidth != bannerCellWidth || TaskManager::TEXT_COLOR != bannerColor) {
+        std::string digits = std::to_string(year < 0 ? -year : year);
+        int yearWidth = 1;
+        for (char digit : digits) {
+            yearWidth += BannerFont::DIGIT_WIDTHS[digit - '0'];
+        }
+        const BannerFont::Glyph& monthGlyph = BannerFont::MONTHS[month - 1];
+        int padding = std::max(0, (cellWidth * 7 - BannerFont::MONTH_WIDTHS[month - 1] - 3 - yearWidth) / 2);
+
+        bannerCache.clear();
+        for (int row = 0; row < BannerFont::GLYPH_HEIGHT; row++) {
+            std::string yearRow = " ";
+            for (char digit : digits) {
+                yearRow += BannerFont::DIGITS[digit - '0'].rows[row];
+            }
+            bannerCache += std::string(padding, ' ');
+            bannerCache += color_text(monthGlyph.rows[row], TaskManager::TEXT_COLOR, 0);
+            bannerCache += "   ";
+            bannerCache += color_text(yearRow, TaskManager::TEXT_COLOR, 0);
+            bannerCache += '\n';
+        }
+        bannerYear = year;
+        bannerMonth = month;
+        bannerCellWidth = cellWidth;
+        bannerColor = TaskManager::TEXT_COLOR;
     }
+    out << bannerCache;
 }
 
-size_t TaskManager::count_utf8_characters_wstring(const std::string& str) {
-    size_t count = 0;
-    for (size_t i = 0; i < str.size(); ) {
-        unsigned char c = str[i];
-        if ((c & 0x80) == 0x00) i += 1;           // 1-byte char
-        else if ((c & 0xE0) == 0xC0) i += 2;      // 2-byte char
-        else if ((c & 0xF0) == 0xE0) i += 3;      // 3-byte char
-        else if ((c & 0xF8) == 0xF0) i += 4;      // 4-byte char
-        else i += 1;  // Fallback: skip invalid byte
-        count++;
+bool TaskManager::parseTag(std::string_view word, std::string& tag) {
+    if (word.size() < 2 || word[0] != '#' || !std::isalpha(static_cast<unsigned char>(word[1]))) return false;
+    tag.clear();
+    for (char c : word.substr(1)) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '/') return false;
+        tag += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
     }
-    return count;
+    return true;
 }
 
-void TaskManager::addTask(const std::string& description, const std::string& deadline) {
-    Task task;
-    task.id = nextId++;
-    task.description = description;
-    
-    if (deadline.empty()) {
-        task.deadline = getCurrentDateTime();
-    } else if (deadline.length() == 10 && deadline[4] == '-' && deadline[7] == '-') {
-        task.deadline = deadline + " 00:00";
+bool TaskManager::parsePriority(std::string_view word, TaskStore::Priority& priority) {
+    if (word == "!high") {
+        priority = TaskStore::HIGH;
+    } else if (word == "!medium" || word == "!med") {
+        priority = TaskStore::MEDIUM;
+    } else if (word == "!low") {
+        priority = TaskStore::LOW;
+    } else if (word == "!none") {
+        priority = TaskStore::NONE;
     } else {
-        task.deadline = deadline;
-    }
-    int month = getMonthOfTask(task.deadline);
-    int day = getDayOfTask(task.deadline);
-    int year = getYearOfTask(task.deadline);
-    task.month = month;
-    task.day = day;
-    task.year = year;
-    task.completed = false;
-    
-    tasks[task.month].push_back(task);
-    taskList.push_back(task);
+        return false;
+    }
+    return true;
+}
 
-    std::string executableDirectory = getExecutableDirectory();
-    std::ifstream file(executableDirectory + "/config.json");
-    if (!file){
-        std::cerr << "Could not open the config file" << std::endl;
+std::string_view TaskManager::priorityName(TaskStore::Priority priority) {
+    switch (priority) {
+        case TaskStore::HIGH: return "high";
+        case TaskStore::MEDIUM: return "medium";
+        case TaskStore::LOW: return "low";
+        default: return "";
     }
-    file >> TaskManager::configFile;
+}
+
+void TaskManager::addTask(const std::string& description, const std::string& deadline, int calendar,
+                          const std::vector<std::string>& tags, TaskStore::Priority priority, const TimeZone* zone) {
+    int id = calendars[calendar].nextId++;
+    std::string tagList;
+    for (size_t i = 0; i < tags.size(); i++) {
+        if (std::find(tags.begin(), tags.begin() + i, tags[i]) != tags.begin() + i) continue;
+        if (!tagList.empty()) tagList += ',';
+        tagList += tags[i];
+    }
+    
+    // The deadline is a wall time in the task's zone; it is stored in UTC and shown in local time
+    const TimeZone& local = TimeZone::local();
+    int64_t wall;
+    if (deadline.empty() || !TimeZone::parseWallTime(deadline, wall)) {
+        wall = TimeZone::toSeconds((zone ? *zone : local).now());
+    }
+    int64_t utc = (zone ? *zone : local).toUtc(wall);
+    int64_t localSeconds = local.toLocal(utc);
+    CivilTime date = TimeZone::toCivil(localSeconds);
+    char fullDeadline[16];
+    size_t length = TimeZone::formatWallTime(localSeconds, ' ', fullDeadline);
+    // The task's segment is written back whole, so the tasks already in it are loaded first
+    int year = TimeZone::toCivil(utc).year;
+    loadYearsWhere([&](size_t i, const TaskSegments::Segment& segment) {
+        return i == static_cast<size_t>(calendar) && segment.year == year;
+    });
+    store.add(id, TaskStore::packDate(date.year, date.month, date.day), description, std::string_view(fullDeadline, length), utc / 60,
+              false, static_cast<uint8_t>(calendar), tagList, priority, zone ? zone->id() : 0);
+    calendars[calendar].dirtyYears.insert(year);
+
+    readConfigFile();
     std::string sortMethod = TaskManager::configFile["EVENT_SORT"];
     if (sortMethod.compare("ID") == 0){
         sortByID();
@@ -425,60 +828,233 @@ void TaskManager::addTask(const std::string& description, const std::string& dea
     }
     saveTasks();
     
-    std::cout << color_text("Task added with ID ", TaskManager::TEXT_COLOR) << task.id << std::endl;
+    out << color_text("Task added with ID ", TaskManager::TEXT_COLOR) << taskLabel(id, static_cast<uint8_t>(calendar)) << "\n";
 }
 
-void TaskManager::listTasks(bool all) {
-    if (taskList.empty()) {
-        std::cout << color_text("No tasks found.", TaskManager::TEXT_COLOR) << std::endl;
-        return;
-    }
-    
-    std::cout << std::left 
-              << std::setw(5) << color_text("ID", TaskManager::TEXT_COLOR) << "   "
+void TaskManager::printTaskHeader() {
+    out << std::left 
+              << std::setw(5) << color_text("ID", TaskManager::TEXT_COLOR) << std::string(idColumnWidth() - 2, ' ')
               << std::setw(50) << color_text("Description", TaskManager::TEXT_COLOR) 
               << std::setw(20) << color_text("Deadline", TaskManager::TEXT_COLOR) 
-              << color_text("Status", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text(std::string(80, '-'), TaskManager::TEXT_COLOR) << std::endl;
-    
-    for (const auto& task : taskList) {
-        if (all || !task.completed) {
-            std::cout << std::left 
-                      << std::setw(5) << color_text(std::to_string(task.id), TaskManager::TEXT_COLOR) << std::string(5 - static_cast<int>(std::to_string(task.id).size()), ' ') 
-                      << std::setw(50) << color_text(task.description, TaskManager::TEXT_COLOR)
-                      << std::setw(20) << color_text(task.deadline, TaskManager::TEXT_COLOR) << " " 
-                      << (task.completed ? color_text("Completed", TaskManager::TEXT_COLOR) : color_text("Pending", TaskManager::TEXT_COLOR)) << std::endl;
+              << color_text("Status", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text(std::string(80, '-'), TaskManager::TEXT_COLOR) << "\n";
+}
+
+// Columns of the ID column: room for "name:id" plus a gap once several calendars are open
+size_t TaskManager::idColumnWidth() const {
+    if (calendars.size() == 1) return 5;
+    size_t longest = 0;
+    for (const Calendar& calendar : calendars) {
+        longest = std::max(longest, calendar.name.size());
+    }
+    return longest + 9;
+}
+
+// Prints up to count matching rows starting at firstRow and returns the row after the last one
+// visited. Each row is written piecewise so nothing is allocated per task; padding keeps the
+// layout of the setw-over-colored-text header.
+size_t TaskManager::printTaskRows(bool all, size_t firstRow, size_t count, const TagFilter& filter) {
+    std::string colored = color_text("", TaskManager::TEXT_COLOR);
+    size_t split = colored.find("\033[0m");
+    std::string_view prefix = split == std::string::npos ? std::string_view() : std::string_view(colored).substr(0, split);
+    std::string_view suffix = split == std::string::npos ? std::string_view() : std::string_view(colored).substr(split);
+    size_t overhead = prefix.size() + suffix.size();
+    auto pad = [&](size_t width, size_t used) {
+        for (size_t i = overhead + used; i < width; i++) out.put(' ');
+    };
+
+    // With several calendars the id is prefixed by the calendar name, in the calendar's color
+    size_t idWidth = idColumnWidth();
+    std::vector<std::string> calendarPrefixes;
+    if (calendars.size() > 1) {
+        for (size_t i = 0; i < calendars.size(); i++) {
+            std::string calendarColored = color_text(calendars[i].name + ":", calendarColor(static_cast<uint8_t>(i)));
+            calendarPrefixes.push_back(calendarColored.substr(0, calendarColored.rfind(':') + 1));
         }
     }
+
+    char id[16];
+    size_t row = firstRow;
+    for (size_t printed = 0; row < store.size() && printed < count; row++) {
+        bool completed = store.completed(row);
+        if ((!all && completed) || !filter.matches(store.key(row))) continue;
+        if (printed % 64 == 0 && sink->discards()) break;
+        size_t idLength = static_cast<size_t>(std::to_chars(id, id + sizeof(id), store.id(row)).ptr - id);
+        if (calendarPrefixes.empty()) {
+            out << prefix << std::string_view(id, idLength) << suffix;
+            pad(5, idLength);
+        } else {
+            out << calendarPrefixes[store.calendar(row)] << std::string_view(id, idLength) << "\033[0m";
+            idLength += calendars[store.calendar(row)].name.size() + 1;
+        }
+        for (size_t i = idLength; i < idWidth; i++) out.put(' ');
+        out << prefix << store.description(row);
+        size_t descriptionWidth = store.descriptionWidth(row);
+        std::string_view tags = store.tags(row);
+        while (!tags.empty()) {
+            size_t comma = tags.find(',');
+            std::string_view tag = tags.substr(0, comma);
+            out << " #" << tag;
+            descriptionWidth += tag.size() + 2;
+            tags = comma == std::string_view::npos ? std::string_view() : tags.substr(comma + 1);
+        }
+        std::string_view priority = priorityName(store.priority(row));
+        if (!priority.empty()) {
+            out << " !" << priority;
+            descriptionWidth += priority.size() + 2;
+        }
+        out << suffix;
+        pad(50, descriptionWidth);
+        std::string_view deadline = store.deadline(row);
+        out << prefix << deadline << suffix;
+        pad(20, deadline.size());
+        out << " " << prefix << (completed ? "Completed" : "Pending") << suffix << "\n";
+        printed++;
+    }
+    return row;
 }
 
-void TaskManager::listTasksByDay(int month, int day){
-    if (month < 1) {
-        std::cout << color_text("Invalid month. Please enter a value between 1 and 12.\n", TaskManager::TEXT_COLOR);
-        return;
+// Height of the terminal behind stdout, or 0 when output does not go to a terminal
+int TaskManager::terminalRows() {
+#ifdef _WIN32
+    // No window size query without ioctl, so listings are never paged
+    return 0;
+#else
+    if (sink != &stdoutSink || !isatty(STDOUT_FILENO)) return 0;
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0) return 0;
+    return size.ws_row;
+#endif
+}
+
+std::vector<uint32_t> TaskManager::filteredRows(bool all, const TagFilter& filter) const {
+    std::vector<uint32_t> rows;
+    rows.reserve(filter.keys.size());
+    for (size_t row = 0; row < store.size() && rows.size() < filter.keys.size(); row++) {
+        if ((all || !store.completed(row)) && filter.matches(store.key(row))) rows.push_back(static_cast<uint32_t>(row));
     }
-    
-    int newYear;
-    
-    if (month > 12){
-        newYear = static_cast<int>(month/12);
-        month = month % 12;
+    return rows;
+}
+
+void TaskManager::printNoTagged(const std::vector<std::string>& tags) {
+    std::string names;
+    for (const std::string& tag : tags) {
+        names += (names.empty() ? "#" : " #") + tag;
     }
-    else {
-        newYear = 0;
+    out << color_text("No tasks tagged " + names + ".", TaskManager::TEXT_COLOR) << "\n";
+}
+
+void TaskManager::listTasks(bool all, int page, const std::vector<std::string>& tags) {
+    if (sink->discards()) return;
+    loadListed(all);
+    if (store.empty()) {
+        out << color_text("No tasks found.", TaskManager::TEXT_COLOR) << "\n";
+        return;
     }
-    
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    int year = 1900 + ltm->tm_year + newYear;
-
-    std::vector<Task> TasksForTheDay;
-    for (int i = 0; i < static_cast<int>(taskList.size()); i ++){
-        if (taskList[i].day == day && taskList[i].month == month && taskList[i].year == year){
-            TasksForTheDay.push_back(taskList[i]);
+
+    // A tag filter resolves to its matching rows up front, which also gives the page boundaries
+    TagFilter filter = store.tagFilter(tags);
+    std::vector<uint32_t> matched;
+    if (filter.active) {
+        matched = filteredRows(all, filter);
+        if (matched.empty()) {
+            printNoTagged(tags);
+            return;
         }
     }
 
+    size_t total = filter.active ? matched.size() : all ? store.size() : store.countPending();
+    // Header, separator, page footer and the prompt stay on screen around the rows
+    int rows = terminalRows();
+    size_t pageSize = static_cast<size_t>(std::max((rows > 0 ? rows : 24) - 4, 1));
+    bool paged = page > 0 || (rows > 0 && total > pageSize);
+    if (!paged) {
+        printTaskHeader();
+        printTaskRows(all, filter.active ? matched[0] : 0, total, filter);
+        return;
+    }
+
+    size_t pages = std::max<size_t>((total + pageSize - 1) / pageSize, 1);
+    if (page == 0) page = 1;
+    if (static_cast<size_t>(page) > pages) {
+        out << color_text("Invalid page. Pages run from 1 to " + std::to_string(pages) + ".", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+
+    size_t skip = static_cast<size_t>(page - 1) * pageSize;
+    size_t firstRow = filter.active ? matched[skip] : all ? skip : store.nthPending(skip);
+    printTaskHeader();
+    if (firstRow != TaskStore::npos) {
+        printTaskRows(all, firstRow, pageSize, filter);
+    }
+    std::string command = all ? "lsa" : "ls";
+    out << color_text("Page " + std::to_string(page) + " of " + std::to_string(pages) + " (" + std::to_string(total) + " tasks). '"
+                      + command + " -p <N>' shows another page, '" + command + " --pager' browses all.", TaskManager::TEXT_COLOR) << "\n";
+}
+
+// Streams the full listing into $PAGER (less by default). Rows are formatted as the pager reads
+// them, so the first screen shows up straight away and quitting early stops the formatting.
+void TaskManager::pageTasks(bool all, const std::vector<std::string>& tags) {
+#ifdef _WIN32
+    // popen and SIGPIPE are POSIX only
+    (void)all;
+    (void)tags;
+    out << color_text("Error: The pager is not supported on this platform.", TaskManager::TEXT_COLOR) << "\n";
+#else
+    if (sink->discards()) return;
+    loadListed(all);
+    if (store.empty()) {
+        out << color_text("No tasks found.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+    TagFilter filter = store.tagFilter(tags);
+    if (filter.active && filter.keys.empty()) {
+        printNoTagged(tags);
+        return;
+    }
+
+    const char* pager = std::getenv("PAGER");
+    std::string command = pager && *pager ? pager : "less -R";
+    // The pager takes over the terminal, so everything before it has to be on screen first
+    out.flush();
+    sink->drain();
+    FILE* pipe = popen(command.c_str(), "w");
+    if (!pipe) {
+        out << color_text("Error: Could not start pager '" + command + "'.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+
+    void (*previousHandler)(int) = std::signal(SIGPIPE, SIG_IGN);
+    OutputSink* previous = sink;
+    {
+        FdSink pagerSink(fileno(pipe), 4096);
+        setOutputSink(&pagerSink);
+        printTaskHeader();
+        printTaskRows(all, 0, store.size(), filter);
+        setOutputSink(previous);
+    }
+    pclose(pipe);
+    std::signal(SIGPIPE, previousHandler);
+#endif
+}
+
+void TaskManager::listTasksByDay(CivilDate::YearMonth shown, int day, const std::vector<std::string>& tags){
+    if (sink->discards()) return;
+    int year = shown.year;
+    int month = shown.month;
+    loadMonth(year, month);
+
+    std::vector<uint32_t> TasksForTheDay;
+    if (day >= 1 && day <= 31 && (store.busyDays(year, month) & (1u << day))) {
+        TasksForTheDay = store.rowsOnDate(TaskStore::packDate(year, month, day));
+    }
+    TagFilter filter = store.tagFilter(tags);
+    if (filter.active) {
+        TasksForTheDay.erase(std::remove_if(TasksForTheDay.begin(), TasksForTheDay.end(), [&](uint32_t row) {
+            return !filter.matches(store.key(row));
+        }), TasksForTheDay.end());
+    }
+
     std::map<int, std::string> monthMap = {
         {1, "January"}, {2, "February"}, {3, "March"}, {4, "April"},
         {5, "May"}, {6, "June"}, {7, "July"}, {8, "August"},
@@ -486,193 +1062,517 @@ void TaskManager::listTasksByDay(int month, int day){
     };
 
     if (TasksForTheDay.empty()){
-        std::cout << "No tasks scheduled for " << monthMap[month] << " " << day << std::endl; 
+        out << "No " << (filter.active ? "matching " : "") << "tasks scheduled for " << monthMap[month] << " " << day << "\n"; 
         return ;
     }
 
-    std::cout << std::left << "Events for " << monthMap[month] << " " << day << ": \n \n";
+    out << std::left << "Events for " << monthMap[month] << " " << day << ": \n \n";
     
-    std::cout << std::left 
-              << std::setw(5) << color_text("ID", TaskManager::TEXT_COLOR) << "   "
+    size_t idWidth = idColumnWidth();
+    out << std::left 
+              << std::setw(5) << color_text("ID", TaskManager::TEXT_COLOR) << std::string(idWidth - 2, ' ')
               << std::setw(50) << color_text("Description", TaskManager::TEXT_COLOR) 
-              << color_text("Status", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text(std::string(80, '-'), TaskManager::TEXT_COLOR) << std::endl;
-
-    for (const auto& task : TasksForTheDay) {
-        std::cout << std::left 
-                  << std::setw(5) << color_text(std::to_string(task.id), TaskManager::TEXT_COLOR) << std::string(5 - static_cast<int>(std::to_string(task.id).size()), ' ') 
-                  << std::setw(50) << color_text(task.description, TaskManager::TEXT_COLOR)
-                  << (task.completed ? color_text("Completed", TaskManager::TEXT_COLOR) : color_text("Pending", TaskManager::TEXT_COLOR)) << std::endl;
-    }
-}
-
-void TaskManager::completeTask(int id) {
-    for (int i = 1; i < 13; i ++){
-        if (! tasks[i].empty()){
-            for (auto& task : tasks[i]) {
-                if (task.id == id) {
-                    task.completed = true;
-                    saveTasks();
-                    std::cout << color_text("Task ", TaskManager::TEXT_COLOR) << id << color_text(" marked as completed.", TaskManager::TEXT_COLOR) << std::endl;
-                    return;
-                }
-            }
+              << color_text("Status", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text(std::string(80, '-'), TaskManager::TEXT_COLOR) << "\n";
+
+    for (uint32_t row : TasksForTheDay) {
+        std::string id = taskLabel(store.id(row), store.calendar(row));
+        const std::string& idColor = calendars.size() > 1 ? calendarColor(store.calendar(row)) : TaskManager::TEXT_COLOR;
+        std::string description(store.description(row));
+        std::string_view tags = store.tags(row);
+        while (!tags.empty()) {
+            size_t comma = tags.find(',');
+            description += " #";
+            description += tags.substr(0, comma);
+            tags = comma == std::string_view::npos ? std::string_view() : tags.substr(comma + 1);
         }
-    }
-    for (int i = 0; i < static_cast<int>(taskList.size()); i ++){
-        if (taskList[i].id == id){
-                taskList[i].completed = true;
-                saveTasks();
-                std::cout << color_text("Task ", TaskManager::TEXT_COLOR) << id << color_text(" marked as completed.", TaskManager::TEXT_COLOR) << std::endl;
-                return;
+        if (store.priority(row) != TaskStore::NONE) {
+            description += " !";
+            description += priorityName(store.priority(row));
         }
+        out << std::left 
+                  << std::setw(5) << color_text(id, idColor) << std::string(idWidth - std::min(idWidth, id.size()), ' ') 
+                  << std::setw(50) << color_text(description, TaskManager::TEXT_COLOR)
+                  << (store.completed(row) ? color_text("Completed", TaskManager::TEXT_COLOR) : color_text("Pending", TaskManager::TEXT_COLOR)) << "\n";
     }
-    std::cout << color_text("Task with ID ", TaskManager::TEXT_COLOR) << id << color_text(" not found.", TaskManager::TEXT_COLOR) << std::endl;
 }
 
-void TaskManager::deleteTask(int id) {
-    for (int i = 1; i < 13; i++) {
-        if (!tasks[i].empty()) {
-            for (auto it = tasks[i].begin(); it != tasks[i].end(); ++it) {
-                if (it->id == id) {
-                    tasks[i].erase(it);
-                    saveTasks();
-                    std::cout << color_text("Task ", TaskManager::TEXT_COLOR) << id 
-                              << color_text(" deleted.", TaskManager::TEXT_COLOR) << std::endl;
-                    break;
-                }
-            }
+void TaskManager::exportTasks(RecordWriter::Format format, bool all, const std::vector<std::string>& tags) {
+    if (sink->discards()) return;
+    loadListed(all);
+    TagFilter filter = store.tagFilter(tags);
+    out.flush();
+    RecordWriter writer(*sink, format);
+    for (size_t row = 0; row < store.size(); row++) {
+        bool completed = store.completed(row);
+        if ((!all && completed) || !filter.matches(store.key(row))) continue;
+        if ((row & 0xFFF) == 0 && sink->discards()) break;
+        writer.record(store.id(row), calendars[store.calendar(row)].name, store.description(row), store.deadline(row), store.tags(row),
+                      priorityName(store.priority(row)), completed);
+    }
+}
+
+void TaskManager::exportTasksByDay(RecordWriter::Format format, CivilDate::YearMonth shown, int day, const std::vector<std::string>& tags) {
+    if (sink->discards()) return;
+    int year = shown.year;
+    int month = shown.month;
+    loadMonth(year, month);
+
+    out.flush();
+    RecordWriter writer(*sink, format);
+    if (day < 1 || day > 31 || !(store.busyDays(year, month) & (1u << day))) return;
+    TagFilter filter = store.tagFilter(tags);
+    for (uint32_t row : store.rowsOnDate(TaskStore::packDate(year, month, day))) {
+        if (!filter.matches(store.key(row))) continue;
+        writer.record(store.id(row), calendars[store.calendar(row)].name, store.description(row), store.deadline(row), store.tags(row),
+                      priorityName(store.priority(row)), store.completed(row));
+    }
+}
+
+void TaskManager::exportDeadlines(RecordWriter::Format format, bool overdue, size_t count) {
+    if (sink->discards()) return;
+    loadPendingYears();
+    const DeadlineIndex& deadlines = store.pendingDeadlines();
+    exportEntries(format, overdue ? deadlines.before(DeadlineIndex::now()) : deadlines.from(DeadlineIndex::now(), count));
+}
+
+void TaskManager::exportTop(RecordWriter::Format format, size_t count) {
+    if (sink->discards()) return;
+    loadPendingYears();
+    exportEntries(format, store.pendingDeadlines().top(count));
+}
+
+void TaskManager::exportEntries(RecordWriter::Format format, const std::vector<DeadlineIndex::Entry>& entries) {
+    out.flush();
+    RecordWriter writer(*sink, format);
+    for (const DeadlineIndex::Entry& entry : entries) {
+        writer.record(entry.id, calendars[entry.calendar].name, store.view(entry.description), store.view(entry.deadline), store.view(entry.tags),
+                      priorityName(static_cast<TaskStore::Priority>(entry.priority)), false);
+    }
+}
+
+void TaskManager::listBusyDays(CivilDate::YearMonth shown){
+    if (sink->discards()) return;
+    int year = shown.year;
+    int month = shown.month;
+    loadMonth(year, month);
+
+    const TaskStore::MonthAggregate* counts = store.monthAggregate(year, month);
+    if (counts == nullptr || counts->occupied == 0) {
+        out << color_text("No busy days this month.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+
+    out << std::left
+        << std::setw(8) << "Day" << std::setw(8) << "Total" << std::setw(10) << "Pending" << "Completed" << "\n";
+    out << color_text(std::string(40, '-'), TaskManager::TEXT_COLOR) << "\n";
+    for (int day = 1; day <= 31; day++) {
+        if (!(counts->occupied & (1u << day))) continue;
+        out << std::left
+            << std::setw(8) << day << std::setw(8) << counts->total[day]
+            << std::setw(10) << counts->total[day] - counts->completed[day] << counts->completed[day] << "\n";
+    }
+}
+
+// A bar of width columns, filled in proportion to value / scale
+static std::string reportBar(int64_t value, int64_t scale, int width) {
+    int filled = scale > 0 ? static_cast<int>((value * width + scale / 2) / scale) : 0;
+    std::string bar;
+    for (int i = 0; i < width; i++) {
+        bar += i < filled ? "█" : "░";
+    }
+    return bar;
+}
+
+void TaskManager::report(uint32_t from, uint32_t to) {
+    if (sink->discards()) return;
+    CivilTime now = TimeZone::local().now();
+    int64_t today = CivilDate::daysFromCivil(now.year, now.month, now.day);
+    if (from != 0 && to == 0) to = TaskStore::packDate(now.year, now.month, now.day);
+    if (from > to && to != 0) std::swap(from, to);
+
+    // The segments and the archive in range are merged in first
+    const DailyStats& daily = store.dailyStats();
+    if (from == 0) {
+        loadAllYears();
+        loadArchive();
+    } else {
+        loadDays(dayNumber(from), dayNumber(to));
+        std::vector<uint32_t> months;
+        for (uint32_t month = from >> 5; month <= (to >> 5); month = (month & 0xF) == 12 ? ((month >> 4) + 1) << 4 | 1 : month + 1) {
+            months.push_back(month);
         }
+        loadArchivedMonths(months);
     }
-    for (auto it = taskList.begin(); it != taskList.end(); ++it) {
-        if (it->id == id) {
-            taskList.erase(it);
+    int64_t firstDay, lastDay;
+    if (from == 0) {
+        if (!daily.span(firstDay, lastDay)) {
+            out << color_text("No tasks to report on.", TaskManager::TEXT_COLOR) << "\n";
             return;
         }
+    } else {
+        firstDay = dayNumber(from);
+        lastDay = dayNumber(to);
+    }
+
+    auto formatDay = [](int64_t day) {
+        CivilDate::Date date = CivilDate::civilFromDays(day);
+        char text[16];
+        std::snprintf(text, sizeof(text), "%04d-%02d-%02d", date.year, date.month, date.day);
+        return std::string(text);
+    };
+    auto percent = [](int64_t part, int64_t whole) {
+        return whole > 0 ? std::to_string((part * 100 + whole / 2) / whole) + "%" : std::string("-");
+    };
+
+    DailyStats::Totals all = daily.range(firstDay, lastDay);
+    out << color_text("Report for " + formatDay(firstDay) + " to " + formatDay(lastDay), TaskManager::TEXT_COLOR) << "\n";
+    out << color_text(std::string(60, '-'), TaskManager::TEXT_COLOR) << "\n";
+    out << "Tasks: " << all.total << "   Completed: " << all.completed << " (" << percent(all.completed, all.total) << ")"
+        << "   Pending: " << all.pending() << "\n";
+    // Lateness of the tasks still pending from days already over: now minus their average deadline
+    DailyStats::Totals overdue = daily.range(firstDay, std::min(lastDay, today - 1));
+    if (overdue.pending() > 0) {
+        int64_t late = static_cast<int64_t>(DeadlineIndex::now()) - overdue.pendingMinutes / overdue.pending();
+        char days[32];
+        std::snprintf(days, sizeof(days), "%.1f", static_cast<double>(late) / (24 * 60));
+        out << "Overdue: " << overdue.pending() << ", on average " << days << " days late\n";
+    } else {
+        out << "Overdue: 0\n";
+    }
+    if (all.total == 0) return;
+
+    // One line per week with tasks, or per month over longer ranges; weeks start on Sunday
+    const int BAR_WIDTH = 20;
+    bool byMonth = lastDay - firstDay > 26 * 7;
+    out << "\n" << color_text(byMonth ? "Completed by month" : "Completed by week", TaskManager::TEXT_COLOR) << "\n";
+    int64_t start = byMonth ? firstDay : firstDay - CivilDate::weekday(firstDay);
+    while (start <= lastDay) {
+        int64_t end = start + 6;
+        if (byMonth) {
+            CivilDate::Date date = CivilDate::civilFromDays(start);
+            CivilDate::YearMonth month = CivilDate::YearMonth{date.year, date.month}.plus(1);
+            end = CivilDate::daysFromCivil(month.year, month.month, 1) - 1;
+        }
+        DailyStats::Totals period = daily.range(std::max(start, firstDay), std::min(end, lastDay));
+        if (period.total == 0) {
+            start = end + 1;
+            continue;
+        }
+        std::string label = formatDay(std::max(start, firstDay));
+        out << (byMonth ? label.substr(0, 7) + "   " : label) << "  " << color_text(reportBar(period.completed, period.total, BAR_WIDTH), TaskManager::EVENTS_COLOR)
+            << " " << std::right << std::setw(4) << percent(period.completed, period.total) << "  " << period.completed << "/" << period.total << std::left << "\n";
+        start = end + 1;
+    }
+
+    static const char* WEEKDAYS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    int64_t busiest = 0;
+    DailyStats::Totals byWeekday[7];
+    for (int weekday = 0; weekday < 7; weekday++) {
+        byWeekday[weekday] = daily.weekday(firstDay, lastDay, weekday);
+        busiest = std::max(busiest, byWeekday[weekday].total);
+    }
+    out << "\n" << color_text("Tasks by weekday", TaskManager::TEXT_COLOR) << "\n";
+    for (int weekday = 0; weekday < 7; weekday++) {
+        out << WEEKDAYS[weekday] << "  " << color_text(reportBar(byWeekday[weekday].total, busiest, BAR_WIDTH), TaskManager::EVENTS_COLOR)
+            << " " << byWeekday[weekday].total << (byWeekday[weekday].total == busiest ? "  (busiest)" : "") << "\n";
     }
-    std::cout << color_text("Task with ID ", TaskManager::TEXT_COLOR) << id 
-              << color_text(" not found.", TaskManager::TEXT_COLOR) << std::endl;
 }
 
-void TaskManager::clearTasks(){
-    tasks.clear();
-    taskList.clear();
-    saveTasks();
-    return;
+void TaskManager::completeTask(int id, int calendar) {
+    uint8_t owner = static_cast<uint8_t>(calendar);
+    size_t row = findTask(id, owner);
+    if (row != TaskStore::npos) {
+        store.setCompleted(row, true);
+        markDirty(row);
+        saveTasks();
+        out << color_text("Task ", TaskManager::TEXT_COLOR) << taskLabel(id, owner) << color_text(" marked as completed.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+    out << color_text("Task with ID ", TaskManager::TEXT_COLOR) << taskLabel(id, owner) << color_text(" not found.", TaskManager::TEXT_COLOR) << "\n";
 }
 
-void TaskManager::help() {
-    std::cout << std::endl << color_text("Task Manager - General Commands:", TaskManager::TEXT_COLOR) << std::endl << std::endl;
-    std::cout << color_text("  nt <description> [deadline]       - Add a new task with optional deadline (YYYY-MM-DD [HH:MM])", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  ls                                - List all pending tasks", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  lsa                               - List all tasks including completed ones", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  ft <id>                           - Mark a task as completed", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  dt <id>                           - Delete a task", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  ct                                - Clear all tasks", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  h                                 - Show this help message", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  exit                              - Exit the program", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  c                                 - Display calendar for current month", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  n                                 - Display calendar for next month", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  p                                 - Display calendar for previous month", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  dc <Month name or number (1-12)>  - Display calendar for specified month", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << std::endl << color_text("Task Manager - User-Specific Commands:", TaskManager::TEXT_COLOR) << std::endl << std::endl;
-    std::cout << color_text("  fetch                             - Get your current configurations", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  sh <New cell height (5-10)>       - Set a new height for calendar cells", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  sw <New cell width (12-40)>       - Set a new width for calendar cells", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  t                                 - Toggle whether your calendar app is opened upon adding a new task", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  stc                               - Change the text color", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  scc                               - Change the calendar border color", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  sec                               - Change the color of events on the calendar", TaskManager::TEXT_COLOR) <<std::endl;
-    std::cout << color_text("  stb                               - Change whether the text appears bold", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  scb                               - Change whether the calendar borders appear bold", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("  sort                              - Configure how the events are sorted upon listed", TaskManager::TEXT_COLOR) << std::endl;
+void TaskManager::deleteTask(int id, int calendar) {
+    uint8_t owner = static_cast<uint8_t>(calendar);
+    size_t row = findTask(id, owner);
+    if (row != TaskStore::npos) {
+        if (store.archived(row)) {
+            calendars[owner].archive.removeTasks({{store.date(row) >> 5, {id}}});
+        }
+        markDirty(row);
+        store.remove(row);
+        saveTasks();
+        out << color_text("Task ", TaskManager::TEXT_COLOR) << taskLabel(id, owner) 
+                  << color_text(" deleted.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+    out << color_text("Task with ID ", TaskManager::TEXT_COLOR) << taskLabel(id, owner) 
+              << color_text(" not found.", TaskManager::TEXT_COLOR) << "\n";
 }
 
-void TaskManager::sortByID(){
-    for (int i = 0; i < static_cast<int>(taskList.size()) - 1; ++i) {
-        for (int j = 0; j < static_cast<int>(taskList.size()) - i - 1; ++j) {
-            if (taskList[j].id > taskList[j + 1].id) {
-                std::swap(taskList[j], taskList[j + 1]);
-            }
+void TaskManager::setTaskPriority(int id, TaskStore::Priority priority, int calendar) {
+    uint8_t owner = static_cast<uint8_t>(calendar);
+    size_t row = findTask(id, owner);
+    if (row == TaskStore::npos) {
+        out << color_text("Task with ID ", TaskManager::TEXT_COLOR) << taskLabel(id, owner) << color_text(" not found.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+    if (store.archived(row)) {
+        out << color_text("Task ", TaskManager::TEXT_COLOR) << taskLabel(id, owner) << color_text(" is archived and keeps its priority.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+    if (store.priority(row) != priority) {
+        store.setPriority(row, priority);
+        markDirty(row);
+        saveTasks();
+    }
+    std::string name(priority == TaskStore::NONE ? "none" : priorityName(priority));
+    out << color_text("Task ", TaskManager::TEXT_COLOR) << taskLabel(id, owner) << color_text(" priority set to " + name + ".", TaskManager::TEXT_COLOR) << "\n";
+}
+
+void TaskManager::completeTasks(const TaskSelector& selector) {
+    // Archived tasks are completed already, so the archive is left alone
+    loadSelected(selector);
+    std::vector<uint32_t> rows = store.select(selector);
+    size_t changed = 0;
+    for (uint32_t row : rows) {
+        if (!store.completed(row)) {
+            store.setCompleted(row, true);
+            markDirty(row);
+            changed++;
         }
     }
-    std::string executableDirectory = getExecutableDirectory();
-    std::ifstream file(executableDirectory + "/config.json");
-    if (!file){
-        std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
+    if (changed > 0) {
+        saveTasks();
     }
-    file >> TaskManager::configFile;
-    TaskManager::configFile["EVENT_SORT"] = "ID";
-    std::ofstream outFile(executableDirectory + "/config.json");
-    if (outFile.is_open()) {
-        outFile << TaskManager::configFile.dump(4);
-        outFile.close();
+    if (rows.empty()) {
+        out << color_text("No matching tasks found.", TaskManager::TEXT_COLOR) << "\n";
+        return;
     }
-    TaskManager::SORT_METHOD = "By ID";
+    out << color_text(std::to_string(changed) + (changed == 1 ? " task" : " tasks") + " marked as completed", TaskManager::TEXT_COLOR);
+    if (changed < rows.size()) {
+        out << color_text(" (" + std::to_string(rows.size() - changed) + " already completed)", TaskManager::TEXT_COLOR);
+    }
+    out << color_text(".", TaskManager::TEXT_COLOR) << "\n";
 }
 
-void TaskManager::sortByDeadlineAscending(){
-    for (int i = 0; i < static_cast<int>(taskList.size()) - 1; ++i) {
-        for (int j = 0; j < static_cast<int>(taskList.size()) - i - 1; ++j) {
-            if (taskList[j].year > taskList[j + 1].year){
-                std::swap(taskList[j], taskList[j+1]);
-            }
-            else if (taskList[j].year == taskList[j + 1].year){
-                if (taskList[j].month > taskList[j + 1].month) {
-                    std::swap(taskList[j], taskList[j + 1]);
-                }
-                else if (taskList[j].month == taskList[j + 1].month){
-                    if (taskList[j].day > taskList[j + 1].day){
-                        std::swap(taskList[j], taskList[j+1]);
-                    }
-                }
-            }
+void TaskManager::deleteTasks(const TaskSelector& selector) {
+    // Only segments and archive months the selector can reach are loaded before the scan
+    loadSelected(selector);
+    for (size_t i = 0; i < calendars.size() && !selector.pendingOnly; i++) {
+        const TaskArchive& archive = calendars[i].archive;
+        if (archive.empty() || (selector.calendar >= 0 && static_cast<size_t>(selector.calendar) != i)) continue;
+        if (selector.onDate != 0) {
+            loadArchivedMonth(TaskStore::yearOf(selector.onDate), TaskStore::monthOf(selector.onDate));
+        } else if (selector.before != 0) {
+            std::vector<uint32_t> months = archive.months();
+            months.erase(std::upper_bound(months.begin(), months.end(), selector.before >> 5), months.end());
+            loadArchivedMonths(months);
+        } else if (selector.firstId <= archive.maxId()) {
+            loadArchivedMonths(archive.months());
         }
     }
-    std::string executableDirectory = getExecutableDirectory();
-    std::ifstream file(executableDirectory + "/config.json");
-    if (!file){
-        std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
+
+    std::vector<uint32_t> rows = store.select(selector);
+    if (rows.empty()) {
+        out << color_text("No matching tasks found.", TaskManager::TEXT_COLOR) << "\n";
+        return;
     }
-    file >> TaskManager::configFile;
-    TaskManager::configFile["EVENT_SORT"] = "ASCENDING";
-    std::ofstream outFile(executableDirectory + "/config.json");
-    if (outFile.is_open()) {
-        outFile << TaskManager::configFile.dump(4);
-        outFile.close();
+    std::vector<std::map<uint32_t, std::vector<int>>> archivedIds(calendars.size());
+    for (uint32_t row : rows) {
+        markDirty(row);
+        if (store.archived(row)) {
+            archivedIds[store.calendar(row)][store.date(row) >> 5].push_back(store.id(row));
+        }
     }
-    TaskManager::SORT_METHOD = "By closest";
+    for (size_t i = 0; i < calendars.size(); i++) {
+        if (!archivedIds[i].empty()) {
+            calendars[i].archive.removeTasks(archivedIds[i]);
+        }
+    }
+    store.removeRows(rows);
+    saveTasks();
+    out << color_text(std::to_string(rows.size()) + (rows.size() == 1 ? " task" : " tasks") + " deleted.", TaskManager::TEXT_COLOR) << "\n";
 }
-void TaskManager::sortByDeadlineDescending(){
-    for (int i = 0; i < static_cast<int>(taskList.size()) - 1; ++i) {
-        for (int j = 0; j < static_cast<int>(taskList.size()) - i - 1; ++j) {
-            if (taskList[j].year < taskList[j + 1].year){
-                std::swap(taskList[j], taskList[j+1]);
-            }
-            else if (taskList[j].year == taskList[j + 1].year){
-                if (taskList[j].month < taskList[j + 1].month) {
-                    std::swap(taskList[j], taskList[j + 1]);
-                }
-                else if (taskList[j].month == taskList[j + 1].month){
-                    if (taskList[j].day < taskList[j + 1].day){
-                        std::swap(taskList[j], taskList[j+1]);
-                    }
-                }
-            }
+
+void TaskManager::clearTasks(){
+    store.clear();
+    for (Calendar& calendar : calendars) {
+        calendar.segments.clear();
+        calendar.loadedYears.clear();
+        calendar.dirtyYears.clear();
+        calendar.singleFile = false;
+        calendar.archive.clear();
+        calendar.loadedArchiveMonths.clear();
+    }
+    return;
+}
+
+void TaskManager::archiveTasks() {
+    // Completed tasks are all the archive takes
+    loadYearsWhere([](size_t, const TaskSegments::Segment& segment) {
+        return segment.pendingCount < segment.taskCount;
+    });
+    size_t moved = archiveOldTasks();
+    if (moved > 0) {
+        saveTasks();
+    }
+    size_t archivedCount = 0;
+    for (const Calendar& calendar : calendars) {
+        archivedCount += calendar.archive.taskCount();
+    }
+    if (TaskManager::ARCHIVE_AFTER_DAYS <= 0) {
+        out << color_text("Archiving is disabled (ARCHIVE_AFTER_DAYS is 0 in config.json).", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+    out << color_text("Archived " + std::to_string(moved) + (moved == 1 ? " task" : " tasks") + " completed more than "
+                      + std::to_string(TaskManager::ARCHIVE_AFTER_DAYS) + " days ago. The archive holds "
+                      + std::to_string(archivedCount) + " tasks.", TaskManager::TEXT_COLOR) << "\n";
+}
+
+void TaskManager::printDeadlines(const std::vector<DeadlineIndex::Entry>& entries) {
+    size_t idWidth = idColumnWidth();
+    out << std::left
+        << std::setw(18) << "Due" << std::setw(static_cast<int>(idWidth)) << "ID" << "Description" << "\n";
+    out << color_text(std::string(80, '-'), TaskManager::TEXT_COLOR) << "\n";
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i % 64 == 0 && sink->discards()) break;
+        const DeadlineIndex::Entry& entry = entries[i];
+        std::string label = taskLabel(entry.id, entry.calendar);
+        const std::string& labelColor = calendars.size() > 1 ? calendarColor(entry.calendar) : TaskManager::TEXT_COLOR;
+        std::string_view deadline = store.view(entry.deadline);
+        std::string description(store.view(entry.description));
+        if (entry.priority != TaskStore::NONE) {
+            description += " !";
+            description += priorityName(static_cast<TaskStore::Priority>(entry.priority));
         }
+        out << color_text(deadline, TaskManager::TEXT_COLOR) << std::string(18 - std::min<size_t>(deadline.size(), 17), ' ')
+            << color_text(label, labelColor) << std::string(idWidth - std::min(idWidth - 1, label.size()), ' ')
+            << color_text(description, TaskManager::TEXT_COLOR) << "\n";
     }
-    std::string executableDirectory = getExecutableDirectory();
-    std::ifstream file(executableDirectory + "/config.json");
-    if (!file){
-        std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
+}
+
+void TaskManager::listUpcoming(size_t count) {
+    if (sink->discards()) return;
+    loadPendingYears();
+    std::vector<DeadlineIndex::Entry> entries = store.pendingDeadlines().from(DeadlineIndex::now(), count);
+    if (entries.empty()) {
+        out << color_text("No upcoming deadlines.", TaskManager::TEXT_COLOR) << "\n";
+        return;
     }
-    file >> TaskManager::configFile;
-    TaskManager::configFile["EVENT_SORT"] = "DESCENDING";
-    std::ofstream outFile(executableDirectory + "/config.json");
-    if (outFile.is_open()) {
-        outFile << TaskManager::configFile.dump(4);
-        outFile.close();
+    printDeadlines(entries);
+}
+
+void TaskManager::listOverdue() {
+    if (sink->discards()) return;
+    loadPendingYears();
+    std::vector<DeadlineIndex::Entry> entries = store.pendingDeadlines().before(DeadlineIndex::now());
+    if (entries.empty()) {
+        out << color_text("No overdue tasks.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+    printDeadlines(entries);
+    out << color_text(std::to_string(entries.size()) + (entries.size() == 1 ? " task is" : " tasks are") + " overdue.", TaskManager::TEXT_COLOR) << "\n";
+}
+
+void TaskManager::listTop(size_t count) {
+    if (sink->discards()) return;
+    loadPendingYears();
+    std::vector<DeadlineIndex::Entry> entries = store.pendingDeadlines().top(count);
+    if (entries.empty()) {
+        out << color_text("No pending tasks.", TaskManager::TEXT_COLOR) << "\n";
+        return;
+    }
+    printDeadlines(entries);
+}
+
+uint64_t TaskManager::nextDeadlineAfter(uint64_t minute) {
+    loadPendingYears();
+    return store.pendingDeadlines().nextAfter(minute);
+}
+
+std::string TaskManager::announceDue(uint64_t minute) {
+    loadPendingYears();
+    std::vector<DeadlineIndex::Entry> entries = store.pendingDeadlines().at(minute);
+    std::string summary;
+    for (const DeadlineIndex::Entry& entry : entries) {
+        std::string_view description = store.view(entry.description);
+        out << color_text("Due now: ", TaskManager::TEXT_COLOR) << color_text(taskLabel(entry.id, entry.calendar), calendarColor(entry.calendar))
+            << " " << color_text(description, TaskManager::TEXT_COLOR) << color_text(" (" + std::string(store.view(entry.deadline)) + ")", TaskManager::TEXT_COLOR) << "\n";
+        if (!summary.empty()) summary += ", ";
+        summary += description;
+    }
+    return summary;
+}
+
+void TaskManager::help() {
+    if (sink->discards()) return;
+    out << "\n" << color_text("Task Manager - General Commands:", TaskManager::TEXT_COLOR) << "\n" << "\n";
+    out << color_text("  nt <description> [deadline]       - Add a new task with optional deadline (YYYY-MM-DD [HH:MM] [zone])", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  ls [-p <N> | --pager]             - List all pending tasks (one page per screen)", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  lsa [-p <N> | --pager]            - List all tasks including completed ones", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  ft <id | first-last | filters>    - Mark a task, a range of ids or every match as completed", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  dt <id | first-last | filters>    - Delete a task, a range of ids or every match", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("                                      filters: --completed, --pending, --before YYYY-MM-DD, --day YYYY-MM-DD, @calendar", TaskManager::TEXT_COLOR) << "\n";
+    if (calendars.size() > 1) {
+        out << color_text("                                      ids of other calendars are written calendar:id; nt @calendar adds to one", TaskManager::TEXT_COLOR) << "\n";
     }
+    out << color_text("  ct                                - Clear all tasks", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  archive                           - Move old completed tasks to the archive now", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  upcoming [N]                      - List the next N pending deadlines (default 10)", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  overdue                           - List pending tasks whose deadline has passed", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  top [N]                           - List the N most important pending tasks (default 10)", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  pr <id> <high|medium|low|none>    - Set the priority of a task; nt also takes !high, !medium or !low", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("                                      ls, lsa, <day>, upcoming, overdue and top take --format=jsonl|csv|tsv for scripts", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("                                      #tag words in nt tag the task; ls, lsa, <day>, c, n, p and dc take #tag filters", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  remind                            - Wait for deadlines and announce each one as it comes due (Enter to stop)", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  h                                 - Show this help message", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  stats                             - Show performance counters and latency histograms", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  exit                              - Exit the program", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  c                                 - Display calendar for current month", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  n                                 - Display calendar for next month", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  p                                 - Display calendar for previous month", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  dc <Month name or number (1-12)>  - Display calendar for specified month", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  busy                              - List the days of the displayed month that have tasks", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  report [all | <from> [<to>]]      - Completion by week, overdue lateness and busiest weekdays", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  ui                                - Browse the calendar with arrow keys (q to leave)", TaskManager::TEXT_COLOR) << "\n";
+    out << "\n" << color_text("Task Manager - User-Specific Commands:", TaskManager::TEXT_COLOR) << "\n" << "\n";
+    out << color_text("  fetch                             - Get your current configurations", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  sh <New cell height (5-10)>       - Set the largest height for calendar cells", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  sw <New cell width (13-40)>       - Set the largest width for calendar cells", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  t                                 - Toggle whether your calendar app is opened upon adding a new task", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  stc                               - Change the text color", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  scc                               - Change the calendar border color", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  sec                               - Change the color of events on the calendar", TaskManager::TEXT_COLOR) <<"\n";
+    out << color_text("  stb                               - Change whether the text appears bold", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  scb                               - Change whether the calendar borders appear bold", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  sort                              - Configure how the events are sorted upon listed", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("  sd <SYNC|GROUP|OS> [ms]           - Set how saves reach the disk (fsync each, group every ms, or OS-buffered)", TaskManager::TEXT_COLOR) << "\n";
+}
+
+void TaskManager::sortByID(){
+    PerfStats::ScopedTimer timer(PerfStats::SORT_TASKS);
+    store.sortById();
+    readConfigFile();
+    TaskManager::configFile["EVENT_SORT"] = "ID";
+    writeConfigFile();
+    TaskManager::SORT_METHOD = "By ID";
+}
+
+void TaskManager::sortByDeadlineAscending(){
+    PerfStats::ScopedTimer timer(PerfStats::SORT_TASKS);
+    store.sortByDate(true);
+    readConfigFile();
+    TaskManager::configFile["EVENT_SORT"] = "ASCENDING";
+    writeConfigFile();
+    TaskManager::SORT_METHOD = "By closest";
+}
+void TaskManager::sortByDeadlineDescending(){
+    PerfStats::ScopedTimer timer(PerfStats::SORT_TASKS);
+    store.sortByDate(false);
+    readConfigFile();
+    TaskManager::configFile["EVENT_SORT"] = "DESCENDING";
+    writeConfigFile();
     TaskManager::SORT_METHOD = "By furthest";
 }
 
@@ -689,20 +1589,34 @@ int TaskManager::getICSVal(){
 }
 
 std::vector<Task> TaskManager::getMonthTask(int month){
-    return tasks[month];
+    std::vector<Task> monthTasks;
+    for (size_t row = 0; row < store.size(); row++) {
+        if (TaskStore::monthOf(store.date(row)) == month) {
+            monthTasks.push_back(store.row(row));
+        }
+    }
+    return monthTasks;
+}
+
+std::string_view TaskManager::getDescription(const Task& task) const {
+    return store.view(task.description);
+}
+
+std::string_view TaskManager::getDeadline(const Task& task) const {
+    return store.view(task.deadline);
 }
 
-int TaskManager::getDayOfTask(std::string& deadline){
+int TaskManager::getDayOfTask(std::string_view deadline){
     int day = (deadline[8] - '0')*10 + (deadline[9] - '0');
     return day;
 }
 
-int TaskManager::getMonthOfTask(std::string& deadline){
+int TaskManager::getMonthOfTask(std::string_view deadline){
     int month = (deadline[5] - '0')*10 + (deadline[6] - '0');
     return month;
 }
 
-int TaskManager::getYearOfTask(std::string& deadline){
+int TaskManager::getYearOfTask(std::string_view deadline){
     int year = (deadline[0] - '0')*1000 + (deadline[1] - '0')*100 + (deadline[2] - '0')*10 + (deadline[3] - '0');
     return year;
 }
@@ -729,42 +1643,38 @@ int TaskManager::getTextBold(){
 
 void TaskManager::setCalendarCellWidth(int newWidth){
     try {
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         TaskManager::configFile["CELL_WIDTH"] = newWidth;
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::CELL_WIDTH = newWidth;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
     }
 }
 
+void TaskManager::setDurability(const std::string& durability, int groupCommitMs){
+    AtomicWriter::Durability policy;
+    if (!AtomicWriter::parseDurability(durability, policy)) return;
+    try {
+        readConfigFile();
+        TaskManager::configFile["DURABILITY"] = durability;
+        TaskManager::configFile["GROUP_COMMIT_MS"] = groupCommitMs;
+        AtomicWriter::setPolicy(policy, std::chrono::milliseconds(groupCommitMs));
+        writeConfigFile();
+    } catch (const json::exception& e) {
+        std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
+    }
+}
+
 int TaskManager::getEventDisplay(){
     return TaskManager::EVENT_DISPLAY;
 }
 
 void TaskManager::setCalendarCellHeight(int newHeight){
     try {
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         TaskManager::configFile["CELL_HEIGHT"] = newHeight;
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::CELL_HEIGHT = newHeight;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
@@ -773,12 +1683,7 @@ void TaskManager::setCalendarCellHeight(int newHeight){
 
 void TaskManager::toggleICS(){
     try {
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         int newVal;
         if (TaskManager::configFile["ICS_VALUE"] == 1){
             newVal = 0;
@@ -788,11 +1693,7 @@ void TaskManager::toggleICS(){
             newVal = 1;
             TaskManager::configFile["ICS_VALUE"] = newVal;
         }
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::ICS_VALUE = newVal;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
@@ -806,18 +1707,9 @@ void TaskManager::setCalendarBorderColor(std::string color){
             std::cerr << color_text("Unknown color was selected", TaskManager::TEXT_COLOR) << std::endl;
             return ;
         }
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         TaskManager::configFile["CALENDAR_BORDER_COLOR"] = color;
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::CALENDAR_BORDER_COLOR = color;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
@@ -831,18 +1723,9 @@ void TaskManager::setTextColor(std::string color){
             std::cerr << color_text("Unknown color was selected", TaskManager::TEXT_COLOR) << std::endl;
             return ;
         }
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         TaskManager::configFile["TEXT_COLOR"] = color;
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::TEXT_COLOR = color;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
@@ -856,18 +1739,9 @@ void TaskManager::setEventsColor(std::string color){
             std::cerr << color_text("Unknown color was selected", TaskManager::TEXT_COLOR) << std::endl;
             return ;
         }
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         TaskManager::configFile["EVENTS_COLOR"] = color;
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::EVENTS_COLOR = color;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
@@ -876,12 +1750,7 @@ void TaskManager::setEventsColor(std::string color){
 
 void TaskManager::toggleCalendarBorderBold(){
     try {
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         int newVal;
         if (TaskManager::configFile["CALENDAR_BORDER_BOLD"] == 1){
             newVal = 0;
@@ -891,11 +1760,7 @@ void TaskManager::toggleCalendarBorderBold(){
             newVal = 1;
             TaskManager::configFile["CALENDAR_BORDER_BOLD"] = newVal;
         }
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::CALENDAR_BORDER_BOLD = newVal;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
@@ -904,12 +1769,7 @@ void TaskManager::toggleCalendarBorderBold(){
 
 void TaskManager::toggleTextBold(){
     try {
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         int newVal;
         if (TaskManager::configFile["TEXT_BOLD"] == 1){
             newVal = 0;
@@ -919,11 +1779,7 @@ void TaskManager::toggleTextBold(){
             newVal = 1;
             TaskManager::configFile["TEXT_BOLD"] = newVal;
         }
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::TEXT_BOLD = newVal;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
@@ -932,12 +1788,7 @@ void TaskManager::toggleTextBold(){
 
 void TaskManager::toggleEventDisplay(){
     try {
-        std::string executableDirectory = getExecutableDirectory();
-        std::ifstream file(executableDirectory + "/config.json");
-        if (!file){
-            std::cerr << color_text("Could not open the config file", TaskManager::TEXT_COLOR) << std::endl;
-        }
-        file >> TaskManager::configFile;
+        readConfigFile();
         int newVal;
         if (TaskManager::configFile["EVENT_DISPLAY"] == 1){
             newVal = 0;
@@ -947,219 +1798,256 @@ void TaskManager::toggleEventDisplay(){
             newVal = 1;
             TaskManager::configFile["EVENT_DISPLAY"] = newVal;
         }
-        std::ofstream outFile(executableDirectory + "/config.json");
-        if (outFile.is_open()) {
-            outFile << TaskManager::configFile.dump(4);
-            outFile.close();
-        }
+        writeConfigFile();
         TaskManager::EVENT_DISPLAY = newVal;
     } catch (const json::exception& e) {
         std::cerr << color_text("Error parsing config.json: ", TaskManager::TEXT_COLOR) << e.what() << std::endl;
     }
 };
 
-void TaskManager::displayCalendar(int month, bool useStaticDisplay) {
-    if (month < 1) {
-        std::cout << color_text("Invalid month. Please enter a value between 1 and 12.\n", TaskManager::TEXT_COLOR);
-        return;
-    }
+void TaskManager::displayCalendar(CivilDate::YearMonth shown, bool useStaticDisplay, const std::vector<std::string>& tags) {
+    if (sink->discards()) return;
 
     // Static variable to track if we've displayed a calendar before
     static bool firstCalendarDisplay = true;
-    static int lastCalendarHeight = 0;
     static int savedRow = 1;
     static int savedCol = 1;
 
-    int newYear;
+    if (useStaticDisplay && !firstCalendarDisplay) {
+        moveCursor(savedRow, savedCol);
+        clearFromCursor();
+    }
+
+    if (useStaticDisplay) {
+        if (firstCalendarDisplay) {
+            savedRow = 1;
+            savedCol = 1;
+        }
+        firstCalendarDisplay = false;
+    }
+
+    renderMonth(shown.year, shown.month, 0, tags);
     
-    if (month > 12){
-        newYear = static_cast<int>(month/12);
-        month = month % 12;
+    if (useStaticDisplay) {
+        // Save position at the top of where we just drew the calendar
+        savedRow = 1;  // We'll always redraw from the same position
+        savedCol = 1;
     }
-    else {
-        newYear = 0;
+}
+
+void TaskManager::renderMonth(int year, int month, int selectedDay, const std::vector<std::string>& tags) {
+    PerfStats::ScopedTimer timer(PerfStats::DISPLAY_CALENDAR);
+    if (sink->discards()) return;
+    if (month < 1 || month > 12) return;
+    // Loading segments and archived tasks changes the store, so it happens before the generation is read
+    loadMonth(year, month);
+
+    // A copy, since SIGWINCH may recompute the shared layout while the frame is being drawn, and
+    // the frame has to match the key it is cached under
+    const CalendarLayout layout = calendarLayout();
+    FrameCache::Key key = {year, month, selectedDay, layout.cellWidth, layout.cellHeight,
+                           TaskManager::EVENT_DISPLAY, TaskManager::CALENDAR_BORDER_BOLD, TaskManager::TEXT_BOLD,
+                           TaskManager::CALENDAR_BORDER_COLOR, TaskManager::TEXT_COLOR, TaskManager::EVENTS_COLOR, tags, store.generation()};
+    out.flush();
+    if (const std::string* frame = frames.find(key)) {
+        PerfStats::increment(PerfStats::FRAME_CACHE_HITS);
+        sink->write(frame->data(), frame->size());
+        return;
     }
 
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    int year = 1900 + ltm->tm_year + newYear;
+    OutputSink* target = sink;
+    BufferedSink frame;
+    setOutputSink(&frame);
+    drawMonth(year, month, selectedDay, tags, layout);
+    setOutputSink(target);
+    sink->write(frame.str().data(), frame.str().size());
+    frames.insert(std::move(key), frame.str());
+}
 
-    tm firstDay = {};
-    firstDay.tm_mday = 1;
-    firstDay.tm_mon = month - 1;
-    firstDay.tm_year = year - 1900;
-    mktime(&firstDay);
-    int startWeekday = firstDay.tm_wday;
+void TaskManager::drawMonth(int year, int month, int selectedDay, const std::vector<std::string>& tags, const CalendarLayout& layout) {
+    CivilDate::YearMonth shown = {year, month};
+    int startWeekday = shown.firstWeekday();
 
-    int daysInMonth[] = { 31,28,31,30,31,30,31,31,30,31,30,31 };
-    
     std::vector<int> calendarGrid(42, 0);
-    for (int i = 0; i < daysInMonth[month - 1]; ++i) {
+    for (int i = 0; i < shown.days(); ++i) {
         calendarGrid[startWeekday + i] = i + 1;
     }
     bool hasFifthWeek = (calendarGrid[35] != 0);
-
-    // Calculate actual calendar height for this display
-    int actualCalendarHeight = 8; // Headers and borders
-    if (hasFifthWeek) {
-        actualCalendarHeight += 6 * (CELL_HEIGHT + 1); // 6 weeks
-    } else {
-        actualCalendarHeight += 5 * (CELL_HEIGHT + 1); // 5 weeks
+    // Summary mode reads the per-day counters; only the detailed view needs the rows themselves,
+    // unless a tag filter has to be applied to them
+    const TaskStore::MonthAggregate* monthCounts = store.monthAggregate(year, month);
+    TagFilter filter = store.tagFilter(tags);
+    std::array<std::vector<uint32_t>, 32> eventsByDay;
+    if ((TaskManager::EVENT_DISPLAY != 0 || filter.active) && store.busyDays(year, month) != 0 && !(filter.active && filter.keys.empty())) {
+        eventsByDay = store.rowsByDay(year, month);
     }
-
-    if (useStaticDisplay && !firstCalendarDisplay) {
-        moveCursor(savedRow, savedCol);
-        clearFromCursor();
+    if (filter.active) {
+        for (std::vector<uint32_t>& rows : eventsByDay) {
+            rows.erase(std::remove_if(rows.begin(), rows.end(), [&](uint32_t row) {
+                return !filter.matches(store.key(row));
+            }), rows.end());
+        }
     }
-
-    if (useStaticDisplay) {
-        if (firstCalendarDisplay) {
-            savedRow = 1;
-            savedCol = 1;
+    // A day with more events than its cell holds shows the most important ones; the listing order
+    // is kept within a priority
+    if (TaskManager::EVENT_DISPLAY != 0) {
+        for (std::vector<uint32_t>& rows : eventsByDay) {
+            if (rows.size() <= static_cast<size_t>(layout.eventRows)) continue;
+            std::stable_sort(rows.begin(), rows.end(), [&](uint32_t a, uint32_t b) {
+                return store.priority(a) > store.priority(b);
+            });
         }
-        firstCalendarDisplay = false;
-        lastCalendarHeight = actualCalendarHeight;
     }
 
-    printYearAndMonth(year, month);
-    std::cout << color_text(std::string(TaskManager::getCalendarCellWidth() * 7, '*'), TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
-    std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) << std::endl << " ";
+    printYearAndMonth(year, month, layout);
+    out << color_text(std::string(layout.cellWidth * 7, '*'), TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+    out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) << "\n" << " ";
     
     std::string weekDaysAbr[] = {"Su", "Mo", "Tu", "We", "Th", "Fr"};
     for (int i = 0; i < 6; i ++){
-        std::cout << color_text(weekDaysAbr[i], TaskManager::TEXT_COLOR);
-        for (int j = 0; j < TaskManager::getCalendarCellWidth() - 2; j ++){
-            std::cout << " ";
-        }
+        out << color_text(weekDaysAbr[i], TaskManager::TEXT_COLOR) << layout.weekdayGap;
     }
-    std::cout << color_text("Sa\n", TaskManager::TEXT_COLOR);
+    out << color_text("Sa\n", TaskManager::TEXT_COLOR);
 
     // Rest of the calendar display logic remains the same
     for (int week = 0; week < 6; ++week) {
         if (week == 5 && !hasFifthWeek){
             continue;
         }
-        std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+        out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
         for (int day = 0; day < 7; ++day) {
-            std::cout << color_text(std::string(TaskManager::getCalendarCellWidth() - 1, '*'), TaskManager::CALENDAR_BORDER_COLOR);
-            if (day < 6) std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR);
+            out << color_text(layout.cellRule, TaskManager::CALENDAR_BORDER_COLOR);
+            if (day < 6) out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR);
         }
-        std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
-        std::cout << "\n";
+        out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+        out << "\n";
 
         for (int day = 0; day < 7; ++day) {
             int idx = week * 7 + day;
             int dayNumber = calendarGrid[idx];
             
-            std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+            out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
             if (dayNumber != 0) {
-                std::cout << " " << std::setw(2) << color_text(std::to_string(dayNumber), TaskManager::TEXT_COLOR);
-                for (int i = 0; i < TaskManager::getCalendarCellWidth() - 2 - static_cast<int>(std::to_string(dayNumber).size()); i ++){
-                    std::cout << " ";
-                }
+                std::string number = std::to_string(dayNumber);
+                // Reverse video is its own token so setw pads the number, and it is switched off
+                // explicitly since color_text adds no reset for an unrecognised color
+                bool selected = dayNumber == selectedDay;
+                out << " " << (selected ? "\033[7m" : "") << std::setw(2) << color_text(number, TaskManager::TEXT_COLOR)
+                    << (selected ? "\033[27m" : "");
+                out.write(layout.blankCell.data(), layout.cellWidth - 2 - static_cast<int>(number.size()));
             } else {
-                std::cout << std::string(TaskManager::getCalendarCellWidth() - 1, ' ');
+                out << layout.blankCell;
             }
         }
-        std::cout << color_text("*\n", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+        out << color_text("*\n", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
         
         if (TaskManager::EVENT_DISPLAY == 0){
-            for (int row = 0; row < TaskManager::getCalendarCellHeight() - 3; ++row) {
+            for (int row = 0; row < layout.cellHeight - 3; ++row) {
                 for (int day = 0; day < 7; ++day) {
-                    std::vector<Task> events = tasks[month];
-                    std::vector<Task> eventsForTheDay;
+                    int numberOfEvents = 0;
                     if (row == 1){
                         int idx = week * 7 + day;
                         int dayNumber = calendarGrid[idx];
-                        if (!events.empty()){
-                            for (int i = 0; i < static_cast<int>(events.size()); i ++){
-                                if (events[i].day == dayNumber){
-                                    eventsForTheDay.push_back(events[i]);
-                                }
-                            }
+                        if (filter.active) {
+                            numberOfEvents = static_cast<int>(eventsByDay[dayNumber].size());
+                        } else {
+                            numberOfEvents = monthCounts ? static_cast<int>(monthCounts->total[dayNumber]) : 0;
                         }
                     }
-                    int numberOfEvents = static_cast<int>(eventsForTheDay.size());
                     if (numberOfEvents > 0){
-                        std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) << color_text("📌 Events: ", TaskManager::EVENTS_COLOR) << color_text(std::to_string(numberOfEvents), TaskManager::EVENTS_COLOR) << color_text(std::string(TaskManager::getCalendarCellWidth() - 12 - std::to_string(numberOfEvents).length(), ' '), TaskManager::EVENTS_COLOR); 
+                        out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) << color_text("📌 Events: ", TaskManager::EVENTS_COLOR) << color_text(std::to_string(numberOfEvents), TaskManager::EVENTS_COLOR) << color_text(std::string(std::max(0, layout.cellWidth - 12 - static_cast<int>(std::to_string(numberOfEvents).length())), ' '), TaskManager::EVENTS_COLOR);
                     } else {
-                        std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) << std::string(TaskManager::getCalendarCellWidth() - 1, ' ');
+                        out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) << layout.blankCell;
                     }
                 }
-                std::cout << color_text("*\n", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+                out << color_text("*\n", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
             }
         }
         else {
-            for (int row = 0; row < TaskManager::getCalendarCellHeight() - 3; ++row) {
+            for (int row = 0; row < layout.cellHeight - 3; ++row) {
                 for (int day = 0; day < 7; ++day) {
-                    std::vector<Task> events = tasks[month];
-                    std::vector<Task> eventsForTheDay;
-                    
                     int idx = week * 7 + day;
                     int dayNumber = calendarGrid[idx];
-                    if (!events.empty()){
-                        for (int i = 0; i < static_cast<int>(events.size()); i ++){
-                            if (events[i].day == dayNumber && events[i].year == year){
-                                eventsForTheDay.push_back(events[i]);
-                            }
-                        }
-                    }
+                    const std::vector<uint32_t>& eventsForTheDay = eventsByDay[dayNumber];
                     
                     int numberOfEvents = static_cast<int>(eventsForTheDay.size());
-                    int cellWidth = TaskManager::getCalendarCellWidth();
-                    int maxCellHeight = TaskManager::getCalendarCellHeight() - 3;
+                    int cellWidth = layout.cellWidth;
+                    int maxCellHeight = layout.cellHeight - 3;
                     
-                    if (numberOfEvents > 0 && row >= 1 && (row) <= numberOfEvents && row <= TaskManager::getCalendarCellHeight() - 4) {
-                        if (row == TaskManager::getCalendarCellHeight() - 4 && numberOfEvents > row){
+                    if (numberOfEvents > 0 && row >= 1 && (row) <= numberOfEvents && row <= layout.eventRows) {
+                        if (row == layout.eventRows && numberOfEvents > row){
                             std::string moreText = "(...)";
                             int padding = cellWidth - 1 - static_cast<int>(moreText.length());
-                            std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) 
+                            out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) 
                                       << color_text(moreText, TaskManager::EVENTS_COLOR) 
                                       << std::string(padding, ' ');
                         }
                         else{
-                            std::string description = "📌 " + eventsForTheDay[row - 1].description;
-                            int maxDescLength = cellWidth - 2;
-                            
-                            if (static_cast<int>(description.length()) > maxDescLength) {
-                                description = description.substr(0, maxDescLength - 3) + "...";
-                            }
+                            uint32_t eventRow = eventsForTheDay[row - 1];
+                            size_t descColumns;
+                            std::string description = "📌 " + DisplayWidth::ellipsize(store.description(eventRow), store.descriptionWidth(eventRow), layout.descriptionColumns, &descColumns);
                             
-                            int padding = cellWidth + 1 - static_cast<int>(description.length());
-                            std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) 
-                                      << color_text(description, TaskManager::EVENTS_COLOR) 
+                            int padding = cellWidth - 4 - static_cast<int>(descColumns);
+                            out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) 
+                                      << color_text(description, calendarColor(store.calendar(eventRow))) 
                                       << std::string(padding, ' ');
                         }
                     }
                     else if (numberOfEvents > maxCellHeight && row == maxCellHeight - 1) {
                         std::string moreText = "(...)";
                         int padding = cellWidth - 1 - static_cast<int>(moreText.length());
-                        std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) 
+                        out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) 
                                   << color_text(moreText, TaskManager::EVENTS_COLOR) 
                                   << std::string(padding, ' ');
                     }
                     else {
-                        std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) 
-                                  << std::string(cellWidth - 1, ' ');
+                        out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD) 
+                                  << layout.blankCell;
                     }
                 }
-                std::cout << color_text("*\n", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+                out << color_text("*\n", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
             }
         }
         if ((week == 4 && !hasFifthWeek) || (week == 5 && hasFifthWeek)) {
-            std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+            out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
             for (int day = 0; day < 7; ++day) {
-                std::cout << color_text(std::string(TaskManager::getCalendarCellWidth() - 1, '*'), TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
-                if (day < 6) std::cout << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+                out << color_text(layout.cellRule, TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+                if (day < 6) out << color_text("*", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
             }
-            std::cout << color_text("*\n", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
+            out << color_text("*\n", TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_BOLD);
         }
     }
-    
-    if (useStaticDisplay) {
-        // Save position at the top of where we just drew the calendar
-        savedRow = 1;  // We'll always redraw from the same position
-        savedCol = 1;
+}
+
+void TaskManager::renderDayDetail(int year, int month, int day, int maxRows, int maxColumns) {
+    if (sink->discards() || maxRows < 1) return;
+    loadMonth(year, month);
+    std::vector<uint32_t> rows;
+    if (day >= 1 && day <= 31 && (store.busyDays(year, month) & (1u << day))) {
+        rows = store.rowsOnDate(TaskStore::packDate(year, month, day));
+    }
+
+    char date[16];
+    std::snprintf(date, sizeof(date), "%04d-%02d-%02d", year, month, day);
+    std::string title = std::string(date) + ": " + (rows.empty() ? "no tasks" : std::to_string(rows.size()) + (rows.size() == 1 ? " task" : " tasks"));
+    out << color_text(title, TaskManager::TEXT_COLOR) << "\033[K\n";
+
+    size_t width = static_cast<size_t>(std::max(maxColumns, 1));
+    size_t available = static_cast<size_t>(maxRows - 1);
+    size_t visible = rows.size() <= available ? rows.size() : (available > 0 ? available - 1 : 0);
+    for (size_t i = 0; i < visible; i++) {
+        uint32_t row = rows[i];
+        std::string_view deadline = store.deadline(row);
+        std::string line = "  " + taskLabel(store.id(row), store.calendar(row)) + "  " + (store.completed(row) ? "[x] " : "[ ] ")
+                           + std::string(deadline.size() > 11 ? deadline.substr(11) : "") + "  ";
+        size_t used = line.size();
+        if (used < width) {
+            line += DisplayWidth::ellipsize(store.description(row), store.descriptionWidth(row), width - used);
+        }
+        out << color_text(line, store.completed(row) ? TaskManager::TEXT_COLOR : calendarColor(store.calendar(row))) << "\033[K\n";
+    }
+    if (visible < rows.size() && available > 0) {
+        out << color_text("  (+" + std::to_string(rows.size() - visible) + " more)", TaskManager::TEXT_COLOR) << "\033[K\n";
     }
 }
 
@@ -1174,29 +2062,29 @@ void TaskManager::displayCalendar(const std::string& monthName) {
     std::transform(lowerMonth.begin(), lowerMonth.end(), lowerMonth.begin(), ::tolower);
 
     if (monthMap.find(lowerMonth) == monthMap.end()) {
-        std::cout << "Invalid month name: " << monthName << "\n";
+        out << "Invalid month name: " << monthName << "\n";
         return;
     }
 
-    int month = monthMap[lowerMonth];
-    // Call the int version with static display disabled (for string version)
-    displayCalendar(month, false);
+    // Call the cursor version with static display disabled (for string version)
+    displayCalendar({TimeZone::local().now().year, monthMap[lowerMonth]}, false);
 }
 
 void TaskManager::displaySummary(){
-    std::cout << color_text("╔════════════════════════════════════════════════════════════════════╗", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║  ████████╗███████╗██████╗ ███╗   ███╗██╗███╗   ██╗ █████╗ ██╗      ║", TaskManager::TEXT_COLOR) << "    " << color_text("Welcome to Terminal Calendar!", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║  ╚══██╔══╝██╔════╝██╔══██╗████╗ ████║██║████╗  ██║██╔══██╗██║      ║", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║     ██║   █████╗  ██████╔╝██╔████╔██║██║██╔██╗ ██║███████║██║      ║", TaskManager::TEXT_COLOR) << "    " << color_text("Your current configurations: ", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║     ██║   ██╔══╝  ██╔══██╗██║╚██╔╝██║██║██║╚██╗██║██╔══██║██║      ║", TaskManager::TEXT_COLOR) << "    " << color_text("Grid cell width: ", TaskManager::TEXT_COLOR) << color_text(std::to_string(TaskManager::CELL_WIDTH), TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║     ██║   ███████╗██║  ██║██║ ╚═╝ ██║██║██║ ╚████║██║  ██║███████╗ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Grid cell height: ", TaskManager::TEXT_COLOR) << color_text(std::to_string(TaskManager::CELL_HEIGHT), TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║     ╚═╝   ╚══════╝╚═╝  ╚═╝╚═╝     ╚═╝╚═╝╚═╝  ╚═══╝╚═╝  ╚═╝╚══════╝ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Calendar Border Color: ", TaskManager::CALENDAR_BORDER_COLOR) << color_text(TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_COLOR) << std::endl;
-    std::cout << color_text("║                                                                    ║", TaskManager::TEXT_COLOR) << "    " << color_text("Text Color: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::TEXT_COLOR, TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║  ██████╗ █████╗ ██╗     ███████╗███╗   ██╗██████╗  █████╗ ██████╗  ║", TaskManager::TEXT_COLOR) << "    " << color_text("Calendar Events Color: ", TaskManager::EVENTS_COLOR) << color_text(TaskManager::EVENTS_COLOR, TaskManager::EVENTS_COLOR) << std::endl;
-    std::cout << color_text("║ ██╔════╝██╔══██╗██║     ██╔════╝████╗  ██║██╔══██╗██╔══██╗██╔══██╗ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Bold Calendar Borders: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::CALENDAR_BORDER_BOLD == 1 ? ("True") : ("False"), TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║ ██║     ███████║██║     █████╗  ██╔██╗ ██║██║  ██║███████║██████╔╝ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Bold Text: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::TEXT_BOLD == 1 ? ("True") : ("False"), TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║ ██║     ██╔══██║██║     ██╔══╝  ██║╚██╗██║██║  ██║██╔══██║██╔══██╗ ║", TaskManager::TEXT_COLOR) << "    " << color_text("ICS Enabled: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::ICS_VALUE == 1 ? ("True") : ("False"), TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║ ╚██████╗██║  ██║███████╗███████╗██║ ╚████║██████╔╝██║  ██║██║  ██║ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Events Sorting Method: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::SORT_METHOD, TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("║  ╚═════╝╚═╝  ╚═╝╚══════╝╚══════╝╚═╝  ╚═══╝╚═════╝ ╚═╝  ╚═╝╚═╝  ╚═╝ ║", TaskManager::TEXT_COLOR) << std::endl;
-    std::cout << color_text("╚════════════════════════════════════════════════════════════════════╝", TaskManager::TEXT_COLOR) << std::endl;
+    if (sink->discards()) return;
+    out << color_text("╔════════════════════════════════════════════════════════════════════╗", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║  ████████╗███████╗██████╗ ███╗   ███╗██╗███╗   ██╗ █████╗ ██╗      ║", TaskManager::TEXT_COLOR) << "    " << color_text("Welcome to Terminal Calendar!", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║  ╚══██╔══╝██╔════╝██╔══██╗████╗ ████║██║████╗  ██║██╔══██╗██║      ║", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║     ██║   █████╗  ██████╔╝██╔████╔██║██║██╔██╗ ██║███████║██║      ║", TaskManager::TEXT_COLOR) << "    " << color_text("Your current configurations: ", TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║     ██║   ██╔══╝  ██╔══██╗██║╚██╔╝██║██║██║╚██╗██║██╔══██║██║      ║", TaskManager::TEXT_COLOR) << "    " << color_text("Grid cell width: ", TaskManager::TEXT_COLOR) << color_text(std::to_string(TaskManager::CELL_WIDTH), TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║     ██║   ███████╗██║  ██║██║ ╚═╝ ██║██║██║ ╚████║██║  ██║███████╗ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Grid cell height: ", TaskManager::TEXT_COLOR) << color_text(std::to_string(TaskManager::CELL_HEIGHT), TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║     ╚═╝   ╚══════╝╚═╝  ╚═╝╚═╝     ╚═╝╚═╝╚═╝  ╚═══╝╚═╝  ╚═╝╚══════╝ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Calendar Border Color: ", TaskManager::CALENDAR_BORDER_COLOR) << color_text(TaskManager::CALENDAR_BORDER_COLOR, TaskManager::CALENDAR_BORDER_COLOR) << "\n";
+    out << color_text("║                                                                    ║", TaskManager::TEXT_COLOR) << "    " << color_text("Text Color: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::TEXT_COLOR, TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║  ██████╗ █████╗ ██╗     ███████╗███╗   ██╗██████╗  █████╗ ██████╗  ║", TaskManager::TEXT_COLOR) << "    " << color_text("Calendar Events Color: ", TaskManager::EVENTS_COLOR) << color_text(TaskManager::EVENTS_COLOR, TaskManager::EVENTS_COLOR) << "\n";
+    out << color_text("║ ██╔════╝██╔══██╗██║     ██╔════╝████╗  ██║██╔══██╗██╔══██╗██╔══██╗ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Bold Calendar Borders: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::CALENDAR_BORDER_BOLD == 1 ? ("True") : ("False"), TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║ ██║     ███████║██║     █████╗  ██╔██╗ ██║██║  ██║███████║██████╔╝ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Bold Text: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::TEXT_BOLD == 1 ? ("True") : ("False"), TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║ ██║     ██╔══██║██║     ██╔══╝  ██║╚██╗██║██║  ██║██╔══██║██╔══██╗ ║", TaskManager::TEXT_COLOR) << "    " << color_text("ICS Enabled: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::ICS_VALUE == 1 ? ("True") : ("False"), TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║ ╚██████╗██║  ██║███████╗███████╗██║ ╚████║██████╔╝██║  ██║██║  ██║ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Events Sorting Method: ", TaskManager::TEXT_COLOR) << color_text(TaskManager::SORT_METHOD, TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("║  ╚═════╝╚═╝  ╚═╝╚══════╝╚══════╝╚═╝  ╚═══╝╚═════╝ ╚═╝  ╚═╝╚═╝  ╚═╝ ║", TaskManager::TEXT_COLOR) << "    " << color_text("Save Durability: ", TaskManager::TEXT_COLOR) << color_text(AtomicWriter::durabilityName(AtomicWriter::getDurability()), TaskManager::TEXT_COLOR) << "\n";
+    out << color_text("╚════════════════════════════════════════════════════════════════════╝", TaskManager::TEXT_COLOR) << "\n";
 }
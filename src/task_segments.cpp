@@ -0,0 +1,194 @@
+#include "../include/task_segments.h"
+#include "../include/perf_stats.h"
+#include "../include/atomic_writer.h"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::string_view MANIFEST_HEADER = "#task-years 1\n";
+
+bool parseNumber(std::string_view& fields, int64_t& value) {
+    size_t end = fields.find('|');
+    std::string_view field = fields.substr(0, end);
+    fields = end == std::string_view::npos ? std::string_view() : fields.substr(end + 1);
+    return std::from_chars(field.data(), field.data() + field.size(), value).ec == std::errc();
+}
+
+// Task counts and id range of a segment's task lines
+void summarize(std::string_view lines, TaskSegments::Segment& segment) {
+    segment.taskCount = 0;
+    segment.pendingCount = 0;
+    segment.minId = INT32_MAX;
+    segment.maxId = 0;
+    while (!lines.empty()) {
+        size_t end = lines.find('\n');
+        std::string_view line = lines.substr(0, end);
+        lines = end == std::string_view::npos ? std::string_view() : lines.substr(end + 1);
+        int id;
+        if (std::from_chars(line.data(), line.data() + line.size(), id).ec != std::errc()) continue;
+        size_t first = line.find('|');
+        size_t second = first == std::string_view::npos ? first : line.find('|', first + 1);
+        size_t third = second == std::string_view::npos ? second : line.find('|', second + 1);
+        if (third == std::string_view::npos) continue;
+        segment.taskCount++;
+        if (line.substr(third + 1, 1) != "1") segment.pendingCount++;
+        segment.minId = std::min(segment.minId, static_cast<int32_t>(id));
+        segment.maxId = std::max(segment.maxId, static_cast<int32_t>(id));
+    }
+    if (segment.taskCount == 0) segment.minId = 0;
+}
+
+}
+
+void TaskSegments::setPath(const std::string& taskFile) {
+    path = taskFile;
+    index.clear();
+}
+
+const std::string& TaskSegments::getPath() const {
+    return path;
+}
+
+std::string TaskSegments::segmentPath(int year) const {
+    return path + ".years/" + std::to_string(year) + ".dat";
+}
+
+TaskSegments::Layout TaskSegments::open(std::string& contents) {
+    index.clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return Layout::MISSING;
+    PerfStats::increment(PerfStats::FILE_OPENS);
+    file.seekg(0, std::ios::end);
+    contents.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(&contents[0], static_cast<std::streamsize>(contents.size()));
+    if (std::string_view(contents).substr(0, MANIFEST_HEADER.size()) != MANIFEST_HEADER) return Layout::SINGLE_FILE;
+
+    // year|size|tasks|pending|first id|last id
+    std::string_view remaining = std::string_view(contents).substr(MANIFEST_HEADER.size());
+    while (!remaining.empty()) {
+        size_t end = remaining.find('\n');
+        std::string_view fields = remaining.substr(0, end);
+        remaining = end == std::string_view::npos ? std::string_view() : remaining.substr(end + 1);
+        int64_t year, size, tasks, pending, minId, maxId;
+        if (!parseNumber(fields, year) || !parseNumber(fields, size) || !parseNumber(fields, tasks)
+            || !parseNumber(fields, pending) || !parseNumber(fields, minId) || !parseNumber(fields, maxId)) continue;
+        index.push_back({static_cast<int>(year), static_cast<uint64_t>(size), static_cast<uint32_t>(tasks),
+                         static_cast<uint32_t>(pending), static_cast<int32_t>(minId), static_cast<int32_t>(maxId), false});
+    }
+    contents.clear();
+
+    // The segments are written before the manifest, so after a crash the files on disk win: a
+    // listed year whose file is gone was emptied, and a file that differs from its entry or is
+    // not listed at all has to be read to learn what it holds
+    std::error_code error;
+    index.erase(std::remove_if(index.begin(), index.end(), [&](Segment& segment) {
+        uintmax_t size = fs::file_size(segmentPath(segment.year), error);
+        if (error) return true;
+        segment.stale = size != segment.size;
+        return false;
+    }), index.end());
+    for (fs::directory_iterator it(path + ".years", error), end; !error && it != end; it.increment(error)) {
+        std::string name = it->path().filename().string();
+        int year;
+        auto parsed = std::from_chars(name.data(), name.data() + name.size(), year);
+        if (parsed.ec != std::errc() || std::string_view(parsed.ptr) != ".dat") continue;
+        if (std::none_of(index.begin(), index.end(), [year](const Segment& segment) { return segment.year == year; })) {
+            index.push_back({year, 0, 0, 0, 0, 0, true});
+        }
+    }
+    std::sort(index.begin(), index.end(), [](const Segment& a, const Segment& b) {
+        return a.year < b.year;
+    });
+    return Layout::SEGMENTED;
+}
+
+int TaskSegments::maxId() const {
+    int highest = 0;
+    for (const Segment& segment : index) highest = std::max(highest, static_cast<int>(segment.maxId));
+    return highest;
+}
+
+const std::vector<TaskSegments::Segment>& TaskSegments::segments() const {
+    return index;
+}
+
+bool TaskSegments::readYear(int year, std::string& lines) const {
+    std::ifstream file(segmentPath(year), std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Could not open task segment " << segmentPath(year) << "." << std::endl;
+        return false;
+    }
+    PerfStats::increment(PerfStats::FILE_OPENS);
+    file.seekg(0, std::ios::end);
+    size_t start = lines.size();
+    lines.resize(start + static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(&lines[start], static_cast<std::streamsize>(lines.size() - start));
+    if (start < lines.size() && lines.back() != '\n') lines += '\n';
+    return true;
+}
+
+bool TaskSegments::write(const std::map<int, std::string>& linesByYear) {
+    std::error_code error;
+    fs::create_directories(path + ".years", error);
+    bool ok = true;
+    for (const auto& [year, lines] : linesByYear) {
+        auto it = std::lower_bound(index.begin(), index.end(), year, [](const Segment& segment, int key) {
+            return segment.year < key;
+        });
+        bool listed = it != index.end() && it->year == year;
+        if (lines.empty()) {
+            if (listed) {
+                std::remove(segmentPath(year).c_str());
+                index.erase(it);
+            }
+            continue;
+        }
+        if (!AtomicWriter::commit(segmentPath(year), lines)) {
+            ok = false;
+            continue;
+        }
+        Segment segment = {year, lines.size(), 0, 0, 0, 0, false};
+        summarize(lines, segment);
+        if (listed) {
+            *it = segment;
+        } else {
+            index.insert(it, segment);
+        }
+    }
+    return writeManifest() && ok;
+}
+
+void TaskSegments::clear() {
+    for (const Segment& segment : index) {
+        std::remove(segmentPath(segment.year).c_str());
+    }
+    index.clear();
+    std::error_code error;
+    fs::remove(path + ".years", error);
+    writeManifest();
+}
+
+bool TaskSegments::writeManifest() {
+    std::string manifest(MANIFEST_HEADER);
+    for (const Segment& segment : index) {
+        for (int64_t field : {static_cast<int64_t>(segment.year), static_cast<int64_t>(segment.size), static_cast<int64_t>(segment.taskCount),
+                              static_cast<int64_t>(segment.pendingCount), static_cast<int64_t>(segment.minId)}) {
+            manifest += std::to_string(field);
+            manifest += '|';
+        }
+        manifest += std::to_string(segment.maxId);
+        manifest += '\n';
+    }
+    return AtomicWriter::commit(path, manifest);
+}
@@ -0,0 +1,401 @@
+#include "../include/task_store.h"
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include "../include/civil_date.h"
+#include "../include/display_width.h"
+
+uint32_t TaskStore::packDate(int year, int month, int day) {
+    return static_cast<uint32_t>(year) << 9 | static_cast<uint32_t>(month) << 5 | static_cast<uint32_t>(day);
+}
+
+int TaskStore::yearOf(uint32_t date) {
+    return static_cast<int>(date >> 9);
+}
+
+int TaskStore::monthOf(uint32_t date) {
+    return static_cast<int>((date >> 5) & 0xF);
+}
+
+int TaskStore::dayOf(uint32_t date) {
+    return static_cast<int>(date & 0x1F);
+}
+
+size_t TaskStore::size() const {
+    return ids.size();
+}
+
+bool TaskStore::empty() const {
+    return ids.empty();
+}
+
+bool TagFilter::matches(uint64_t key) const {
+    return !active || std::binary_search(keys.begin(), keys.end(), key);
+}
+
+size_t TaskStore::add(int id, uint32_t date, std::string_view description, std::string_view deadline, int64_t instant, bool completed,
+                      uint8_t calendar, std::string_view tags, Priority priority, uint16_t zone) {
+    generationCount++;
+    ids.push_back(id);
+    dates.push_back(date);
+    flags.push_back(static_cast<uint8_t>((completed ? COMPLETED : 0) | priority << 2));
+    calendars.push_back(calendar);
+    descriptions.push_back(strings.intern(description));
+    deadlines.push_back(strings.intern(deadline));
+    instants.push_back(instant);
+    zones.push_back(zone);
+    descriptionWidths.push_back(static_cast<uint16_t>(std::min<size_t>(DisplayWidth::columns(description), UINT16_MAX)));
+    tagLists.push_back(strings.intern(tags));
+    account(date, instant, 1, completed ? 1 : 0);
+    if (!tags.empty()) post(ids.size() - 1, true);
+    if (deadlinesIndexed && !completed) deadlineIndex.insert(deadlineEntry(ids.size() - 1));
+    return ids.size() - 1;
+}
+
+void TaskStore::remove(size_t row) {
+    generationCount++;
+    account(dates[row], instants[row], -1, completed(row) ? -1 : 0);
+    if (tagLists[row].length != 0) post(row, false);
+    if (deadlinesIndexed && !completed(row)) deadlineIndex.erase(deadlineEntry(row));
+    ids.erase(ids.begin() + row);
+    dates.erase(dates.begin() + row);
+    flags.erase(flags.begin() + row);
+    calendars.erase(calendars.begin() + row);
+    descriptions.erase(descriptions.begin() + row);
+    deadlines.erase(deadlines.begin() + row);
+    instants.erase(instants.begin() + row);
+    zones.erase(zones.begin() + row);
+    descriptionWidths.erase(descriptionWidths.begin() + row);
+    tagLists.erase(tagLists.begin() + row);
+}
+
+void TaskStore::removeRows(const std::vector<uint32_t>& rows) {
+    generationCount++;
+    std::vector<uint32_t> kept;
+    kept.reserve(ids.size() - rows.size());
+    size_t next = 0;
+    for (uint32_t i = 0; i < ids.size(); i++) {
+        if (next < rows.size() && rows[next] == i) {
+            account(dates[i], instants[i], -1, completed(i) ? -1 : 0);
+            if (tagLists[i].length != 0) post(i, false);
+            if (deadlinesIndexed && !completed(i)) deadlineIndex.erase(deadlineEntry(i));
+            next++;
+        } else {
+            kept.push_back(i);
+        }
+    }
+    permute(kept);
+}
+
+void TaskStore::clear() {
+    generationCount++;
+    ids.clear();
+    dates.clear();
+    flags.clear();
+    calendars.clear();
+    descriptions.clear();
+    deadlines.clear();
+    instants.clear();
+    zones.clear();
+    descriptionWidths.clear();
+    tagLists.clear();
+    postings.clear();
+    strings.clear();
+    aggregates.clear();
+    daily.clear();
+    deadlineIndex.clear();
+    deadlinesIndexed = false;
+}
+
+size_t TaskStore::find(int id, uint8_t calendar) const {
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (ids[i] == id && calendars[i] == calendar) return i;
+    }
+    return npos;
+}
+
+int TaskStore::id(size_t row) const {
+    return ids[row];
+}
+
+uint8_t TaskStore::calendar(size_t row) const {
+    return calendars[row];
+}
+
+uint64_t TaskStore::key(uint8_t calendar, int id) {
+    return static_cast<uint64_t>(calendar) << 32 | static_cast<uint32_t>(id);
+}
+
+uint64_t TaskStore::key(size_t row) const {
+    return key(calendars[row], ids[row]);
+}
+
+std::string_view TaskStore::tags(size_t row) const {
+    return strings.view(tagLists[row]);
+}
+
+uint32_t TaskStore::date(size_t row) const {
+    return dates[row];
+}
+
+bool TaskStore::completed(size_t row) const {
+    return (flags[row] & COMPLETED) != 0;
+}
+
+void TaskStore::setCompleted(size_t row, bool completed) {
+    generationCount++;
+    if (completed != this->completed(row)) {
+        account(dates[row], instants[row], 0, completed ? 1 : -1);
+        if (deadlinesIndexed && completed) {
+            deadlineIndex.erase(deadlineEntry(row));
+        } else if (deadlinesIndexed) {
+            deadlineIndex.insert(deadlineEntry(row));
+        }
+    }
+    if (completed) {
+        flags[row] |= COMPLETED;
+    } else {
+        flags[row] &= static_cast<uint8_t>(~COMPLETED);
+    }
+}
+
+bool TaskStore::archived(size_t row) const {
+    return (flags[row] & ARCHIVED) != 0;
+}
+
+void TaskStore::setArchived(size_t row) {
+    generationCount++;
+    flags[row] |= ARCHIVED;
+}
+
+TaskStore::Priority TaskStore::priority(size_t row) const {
+    return static_cast<Priority>((flags[row] & PRIORITY_MASK) >> 2);
+}
+
+void TaskStore::setPriority(size_t row, Priority priority) {
+    generationCount++;
+    if (priority == this->priority(row)) return;
+    bool indexed = deadlinesIndexed && !completed(row);
+    if (indexed) deadlineIndex.erase(deadlineEntry(row));
+    flags[row] = static_cast<uint8_t>((flags[row] & ~PRIORITY_MASK) | priority << 2);
+    if (indexed) deadlineIndex.insert(deadlineEntry(row));
+}
+
+std::string_view TaskStore::description(size_t row) const {
+    return strings.view(descriptions[row]);
+}
+
+uint16_t TaskStore::descriptionWidth(size_t row) const {
+    return descriptionWidths[row];
+}
+
+std::string_view TaskStore::deadline(size_t row) const {
+    return strings.view(deadlines[row]);
+}
+
+int64_t TaskStore::instant(size_t row) const {
+    return instants[row];
+}
+
+uint16_t TaskStore::zone(size_t row) const {
+    return zones[row];
+}
+
+std::string_view TaskStore::view(StringRef ref) const {
+    return strings.view(ref);
+}
+
+Task TaskStore::row(size_t row) const {
+    Task task;
+    task.id = ids[row];
+    task.description = descriptions[row];
+    task.deadline = deadlines[row];
+    task.completed = completed(row);
+    task.year = yearOf(dates[row]);
+    task.month = monthOf(dates[row]);
+    task.day = dayOf(dates[row]);
+    return task;
+}
+
+std::vector<uint32_t> TaskStore::select(const TaskSelector& selector) const {
+    std::vector<uint32_t> rows;
+    uint32_t before = selector.before != 0 ? selector.before : UINT32_MAX;
+    for (size_t i = 0; i < ids.size(); i++) {
+        bool completed = (flags[i] & COMPLETED) != 0;
+        if (ids[i] < selector.firstId || ids[i] > selector.lastId) continue;
+        if (selector.calendar >= 0 && calendars[i] != selector.calendar) continue;
+        if ((selector.completedOnly && !completed) || (selector.pendingOnly && completed)) continue;
+        if (dates[i] >= before || (selector.onDate != 0 && dates[i] != selector.onDate)) continue;
+        rows.push_back(static_cast<uint32_t>(i));
+    }
+    return rows;
+}
+
+size_t TaskStore::countPending() const {
+    size_t pending = 0;
+    for (size_t i = 0; i < flags.size(); i++) {
+        pending += (flags[i] & COMPLETED) == 0;
+    }
+    return pending;
+}
+
+size_t TaskStore::nthPending(size_t n) const {
+    for (size_t i = 0; i < flags.size(); i++) {
+        if ((flags[i] & COMPLETED) == 0) {
+            if (n == 0) return i;
+            n--;
+        }
+    }
+    return npos;
+}
+
+void TaskStore::account(uint32_t date, int64_t instant, int totalDelta, int completedDelta) {
+    daily.add(CivilDate::daysFromCivil(yearOf(date), monthOf(date), dayOf(date)), totalDelta, completedDelta, instant);
+    MonthAggregate& aggregate = aggregates[date >> 5];
+    uint32_t day = date & 0x1F;
+    aggregate.total[day] += totalDelta;
+    aggregate.completed[day] += completedDelta;
+    if (aggregate.total[day] > 0) {
+        aggregate.occupied |= 1u << day;
+    } else {
+        aggregate.occupied &= ~(1u << day);
+    }
+}
+
+// Adds the row's key to (or removes it from) the posting list of each of its tags
+void TaskStore::post(size_t row, bool add) {
+    uint64_t rowKey = key(row);
+    std::string_view remaining = strings.view(tagLists[row]);
+    while (!remaining.empty()) {
+        size_t comma = remaining.find(',');
+        std::string_view tag = remaining.substr(0, comma);
+        remaining = comma == std::string_view::npos ? std::string_view() : remaining.substr(comma + 1);
+        if (tag.empty()) continue;
+        std::vector<uint64_t>& posting = postings[std::string(tag)];
+        // Files are mostly loaded in id order, so appending is the common case
+        if (add && (posting.empty() || posting.back() < rowKey)) {
+            posting.push_back(rowKey);
+            continue;
+        }
+        auto it = std::lower_bound(posting.begin(), posting.end(), rowKey);
+        if (add && (it == posting.end() || *it != rowKey)) {
+            posting.insert(it, rowKey);
+        } else if (it != posting.end() && *it == rowKey) {
+            posting.erase(it);
+        }
+    }
+}
+
+TagFilter TaskStore::tagFilter(const std::vector<std::string>& tags) const {
+    TagFilter filter;
+    if (tags.empty()) return filter;
+    filter.active = true;
+    std::vector<const std::vector<uint64_t>*> lists;
+    for (const std::string& tag : tags) {
+        auto it = postings.find(tag);
+        if (it == postings.end()) return filter;
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(), [](const std::vector<uint64_t>* a, const std::vector<uint64_t>* b) {
+        return a->size() < b->size();
+    });
+    filter.keys = *lists[0];
+    for (size_t i = 1; i < lists.size() && !filter.keys.empty(); i++) {
+        std::vector<uint64_t> both;
+        std::set_intersection(filter.keys.begin(), filter.keys.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(both));
+        filter.keys.swap(both);
+    }
+    return filter;
+}
+
+DeadlineIndex::Entry TaskStore::deadlineEntry(size_t row) const {
+    return {static_cast<uint64_t>(std::max<int64_t>(instants[row], 0)), calendars[row], ids[row], descriptions[row], deadlines[row],
+            tagLists[row], static_cast<uint8_t>(priority(row))};
+}
+
+const DeadlineIndex& TaskStore::pendingDeadlines() const {
+    if (!deadlinesIndexed) {
+        for (size_t i = 0; i < ids.size(); i++) {
+            if ((flags[i] & COMPLETED) == 0) deadlineIndex.insert(deadlineEntry(i));
+        }
+        deadlinesIndexed = true;
+    }
+    return deadlineIndex;
+}
+
+const DailyStats& TaskStore::dailyStats() const {
+    return daily;
+}
+
+const TaskStore::MonthAggregate* TaskStore::monthAggregate(int year, int month) const {
+    auto it = aggregates.find(packDate(year, month, 0) >> 5);
+    return it == aggregates.end() ? nullptr : &it->second;
+}
+
+uint32_t TaskStore::busyDays(int year, int month) const {
+    const MonthAggregate* aggregate = monthAggregate(year, month);
+    return aggregate ? aggregate->occupied : 0;
+}
+
+std::vector<uint32_t> TaskStore::rowsOnDate(uint32_t date) const {
+    std::vector<uint32_t> rows;
+    for (size_t i = 0; i < dates.size(); i++) {
+        if (dates[i] == date) rows.push_back(static_cast<uint32_t>(i));
+    }
+    return rows;
+}
+
+std::array<std::vector<uint32_t>, 32> TaskStore::rowsByDay(int year, int month) const {
+    std::array<std::vector<uint32_t>, 32> byDay;
+    uint32_t monthKey = packDate(year, month, 0) >> 5;
+    for (size_t i = 0; i < dates.size(); i++) {
+        if ((dates[i] >> 5) == monthKey) {
+            byDay[dates[i] & 0x1F].push_back(static_cast<uint32_t>(i));
+        }
+    }
+    return byDay;
+}
+
+void TaskStore::permute(const std::vector<uint32_t>& order) {
+    generationCount++;
+    auto apply = [&order](auto& column) {
+        std::remove_reference_t<decltype(column)> sorted;
+        sorted.reserve(column.size());
+        for (uint32_t index : order) {
+            sorted.push_back(column[index]);
+        }
+        column.swap(sorted);
+    };
+    apply(ids);
+    apply(dates);
+    apply(flags);
+    apply(calendars);
+    apply(descriptions);
+    apply(deadlines);
+    apply(instants);
+    apply(zones);
+    apply(descriptionWidths);
+    apply(tagLists);
+}
+
+uint64_t TaskStore::generation() const {
+    return generationCount;
+}
+
+void TaskStore::sortById() {
+    std::vector<uint32_t> order(ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return ids[a] < ids[b]; });
+    permute(order);
+}
+
+void TaskStore::sortByDate(bool ascending) {
+    std::vector<uint32_t> order(dates.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (ascending) {
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return dates[a] < dates[b]; });
+    } else {
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return dates[a] > dates[b]; });
+    }
+    permute(order);
+}
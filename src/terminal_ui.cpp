@@ -0,0 +1,279 @@
+#include "../include/terminal_ui.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <string>
+#include <string_view>
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char ESCAPE = '\033';
+const char CTRL_C = 3;
+
+#ifndef _WIN32
+// How long a lone escape byte waits for the rest of an arrow key sequence
+const long ESCAPE_TIMEOUT_US = 30000;
+
+volatile sig_atomic_t resized = 0;
+
+void onResize(int) {
+    resized = 1;
+    CalendarLayout::invalidate();
+}
+
+// Puts the terminal in raw mode and switches to the alternate screen for its lifetime
+class RawMode {
+public:
+    RawMode() : active(false) {
+        if (tcgetattr(STDIN_FILENO, &saved) != 0) return;
+        termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+        raw.c_iflag &= ~(IXON | ICRNL);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        active = tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0;
+    }
+
+    ~RawMode() {
+        if (active) tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved);
+    }
+
+    bool ok() const { return active; }
+
+private:
+    termios saved;
+    bool active;
+};
+
+// Waits up to timeoutUs microseconds (forever when negative) for stdin to become readable.
+// Returns 1 when it is, 0 on a timeout or a signal, and -1 when stdin can no longer be waited on.
+int waitForInput(long timeoutUs) {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(STDIN_FILENO, &readSet);
+    timeval timeout = {timeoutUs / 1000000, timeoutUs % 1000000};
+    int ready = select(STDIN_FILENO + 1, &readSet, nullptr, nullptr, timeoutUs < 0 ? nullptr : &timeout);
+    if (ready < 0) return errno == EINTR ? 0 : -1;
+    return ready > 0 ? 1 : 0;
+}
+#endif
+
+int terminalRows() {
+#ifndef _WIN32
+    winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row != 0) return size.ws_row;
+#endif
+    return 24;
+}
+
+int terminalColumns() {
+#ifndef _WIN32
+    winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col != 0) return size.ws_col;
+#endif
+    return 80;
+}
+
+}
+
+TerminalUI::TerminalUI(TaskManager& manager) : manager(manager), year(0), month(0), day(0) {
+    goToToday();
+}
+
+void TerminalUI::goToToday() {
+    CivilTime today = TimeZone::local().now();
+    year = today.year;
+    month = today.month;
+    day = today.day;
+}
+
+void TerminalUI::moveDays(int delta) {
+    day += delta;
+    while (day < 1) {
+        moveMonths(-1);
+        day += CivilDate::daysInMonth(year, month);
+    }
+    while (day > CivilDate::daysInMonth(year, month)) {
+        day -= CivilDate::daysInMonth(year, month);
+        moveMonths(1);
+    }
+}
+
+void TerminalUI::moveMonths(int delta) {
+    CivilDate::YearMonth shown = CivilDate::YearMonth{year, month}.plus(delta);
+    year = shown.year;
+    month = shown.month;
+    day = std::min(day, shown.days());
+}
+
+size_t TerminalUI::decodeKey(const char* data, size_t length, Key& key) {
+    key = Key::NONE;
+    char c = data[0];
+    if (c != ESCAPE) {
+        switch (c) {
+            case 'h': key = Key::LEFT; break;
+            case 'l': key = Key::RIGHT; break;
+            case 'k': key = Key::UP; break;
+            case 'j': key = Key::DOWN; break;
+            case 'n': case '>': key = Key::NEXT_MONTH; break;
+            case 'p': case '<': key = Key::PREVIOUS_MONTH; break;
+            case 't': key = Key::TODAY; break;
+            case 'q': case CTRL_C: key = Key::QUIT; break;
+            default: break;
+        }
+        return 1;
+    }
+
+    if (length == 1) {
+        key = Key::QUIT;
+        return 1;
+    }
+    if (data[1] != '[' && data[1] != 'O') {
+        return 1;
+    }
+    // CSI or SS3 sequence: parameters then a final byte in 0x40-0x7E
+    size_t end = 2;
+    while (end < length && (data[end] < 0x40 || data[end] > 0x7E)) end++;
+    if (end == length) return length;
+
+    std::string_view sequence(data + 2, end - 2);
+    switch (data[end]) {
+        case 'A': key = Key::UP; break;
+        case 'B': key = Key::DOWN; break;
+        case 'C': key = Key::RIGHT; break;
+        case 'D': key = Key::LEFT; break;
+        case 'H': key = Key::TODAY; break;
+        case '~':
+            if (sequence == "5") key = Key::PREVIOUS_MONTH;
+            else if (sequence == "6") key = Key::NEXT_MONTH;
+            else if (sequence == "1" || sequence == "7") key = Key::TODAY;
+            break;
+        default: break;
+    }
+    return end + 1;
+}
+
+void TerminalUI::render() {
+    // The frame is built in memory and handed over whole. A slow terminal may skip frames, so
+    // none can rely on an earlier one having cleared the screen: every line clears whatever an
+    // older, wider frame left behind it instead.
+    BufferedSink frame;
+    OutputSink& terminal = manager.getOutputSink();
+    manager.setOutputSink(&frame);
+    std::ostream& out = manager.output();
+    out << "\033[H";
+    manager.renderMonth(year, month, day);
+    int detailRows = std::max(terminalRows() - TaskManager::calculateCalendarHeight() - 1, 3);
+    manager.renderDayDetail(year, month, day, detailRows, terminalColumns());
+    out << manager.color_text("arrows/hjkl: day and week   n/p, PgUp/PgDn: month   t: today   q: quit", manager.getTextColor(), 0)
+        << "\033[K\033[J";
+    manager.setOutputSink(&terminal);
+
+    static const std::string_view CLEAR_LINE = "\033[K";
+    const std::string& text = frame.str();
+    std::string screen;
+    screen.reserve(text.size() + text.size() / 16);
+    size_t start = 0;
+    for (size_t newline = text.find('\n'); newline != std::string::npos; newline = text.find('\n', start)) {
+        std::string_view line(text.data() + start, newline - start);
+        screen += line;
+        if (line.size() < CLEAR_LINE.size() || line.substr(line.size() - CLEAR_LINE.size()) != CLEAR_LINE) screen += CLEAR_LINE;
+        screen += '\n';
+        start = newline + 1;
+    }
+    screen.append(text, start, std::string::npos);
+    terminal.write(screen.data(), screen.size());
+    terminal.flushFrame();
+}
+
+void TerminalUI::run() {
+    std::ostream& out = manager.output();
+#ifdef _WIN32
+    // Raw mode and SIGWINCH are POSIX only
+    out << manager.color_text("Error: The interactive view is not supported on this platform.", manager.getTextColor()) << "\n";
+#else
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+        out << manager.color_text("Error: The interactive view needs a terminal.", manager.getTextColor()) << "\n";
+        return;
+    }
+    RawMode rawMode;
+    if (!rawMode.ok()) {
+        out << manager.color_text("Error: Could not switch the terminal to raw mode.", manager.getTextColor()) << "\n";
+        return;
+    }
+
+    struct sigaction action = {};
+    struct sigaction previousAction;
+    action.sa_handler = onResize;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGWINCH, &action, &previousAction);
+
+    out << "\033[?1049h\033[?25l";
+    render();
+
+    char buffer[256];
+    bool running = true;
+    while (running) {
+        int ready = waitForInput(-1);
+        if (ready < 0) break;
+        if (ready == 0) {
+            // Interrupted by SIGWINCH: redraw at the new size
+            if (resized) {
+                resized = 0;
+                render();
+            }
+            continue;
+        }
+
+        // Drain everything that is already queued so a held-down key costs one redraw. Every read
+        // follows a wait that reported input, so reading nothing means end of file or a hangup.
+        size_t length = 0;
+        while (length < sizeof(buffer)) {
+            ssize_t count = read(STDIN_FILENO, buffer + length, sizeof(buffer) - length);
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) {
+                running = false;
+                break;
+            }
+            length += static_cast<size_t>(count);
+            if (buffer[length - 1] == ESCAPE && length < sizeof(buffer) && waitForInput(ESCAPE_TIMEOUT_US) > 0) continue;
+            if (waitForInput(0) <= 0) break;
+        }
+        if (!running) break;
+
+        int startYear = year, startMonth = month, startDay = day;
+        for (size_t pos = 0; pos < length && running;) {
+            Key key;
+            pos += decodeKey(buffer + pos, length - pos, key);
+            switch (key) {
+                case Key::LEFT: moveDays(-1); break;
+                case Key::RIGHT: moveDays(1); break;
+                case Key::UP: moveDays(-7); break;
+                case Key::DOWN: moveDays(7); break;
+                case Key::NEXT_MONTH: moveMonths(1); break;
+                case Key::PREVIOUS_MONTH: moveMonths(-1); break;
+                case Key::TODAY: goToToday(); break;
+                case Key::QUIT: running = false; break;
+                case Key::NONE: break;
+            }
+        }
+        if (running && (year != startYear || month != startMonth || day != startDay || resized)) {
+            resized = 0;
+            render();
+        }
+    }
+
+    out << "\033[?25h\033[?1049l";
+    // Everything must reach the terminal before raw mode is switched off
+    out.flush();
+    manager.getOutputSink().drain();
+    sigaction(SIGWINCH, &previousAction, nullptr);
+#endif
+}
@@ -0,0 +1,394 @@
+#include "../include/time_zone.h"
+#include "../include/civil_date.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace fs = std::filesystem;
+using CivilDate::civilFromDays;
+using CivilDate::daysFromCivil;
+using CivilDate::floorDiv;
+using CivilDate::isLeapYear;
+
+namespace {
+
+// Loaded zones; built on first use so zones can be looked up from other static initializers
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<TimeZone>, std::less<>> byName;
+    std::vector<const TimeZone*> byId;
+};
+
+Registry& registry() {
+    static Registry zones;
+    return zones;
+}
+
+int64_t readBigEndian(const std::string& data, size_t offset, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value = value << 8 | static_cast<uint8_t>(data[offset + i]);
+    }
+    // Sign-extend 32-bit fields
+    if (bytes == 4) return static_cast<int32_t>(static_cast<uint32_t>(value));
+    return static_cast<int64_t>(value);
+}
+
+// Reads [+-]hh[:mm[:ss]] of a POSIX TZ string into seconds
+bool readRuleTime(std::string_view& rule, int64_t& seconds) {
+    int sign = 1;
+    if (!rule.empty() && (rule[0] == '+' || rule[0] == '-')) {
+        sign = rule[0] == '-' ? -1 : 1;
+        rule.remove_prefix(1);
+    }
+    int64_t parts[3] = {0, 0, 0};
+    for (int part = 0; part < 3; part++) {
+        if (rule.empty() || !std::isdigit(static_cast<unsigned char>(rule[0]))) return part > 0;
+        int64_t value = 0;
+        while (!rule.empty() && std::isdigit(static_cast<unsigned char>(rule[0]))) {
+            value = value * 10 + (rule[0] - '0');
+            rule.remove_prefix(1);
+        }
+        parts[part] = value;
+        seconds = sign * (parts[0] * 3600 + parts[1] * 60 + parts[2]);
+        if (rule.empty() || rule[0] != ':') return true;
+        rule.remove_prefix(1);
+    }
+    return true;
+}
+
+// Skips a zone abbreviation: letters, or anything inside <...>
+bool skipAbbreviation(std::string_view& rule) {
+    if (!rule.empty() && rule[0] == '<') {
+        size_t close = rule.find('>');
+        if (close == std::string_view::npos) return false;
+        rule.remove_prefix(close + 1);
+        return true;
+    }
+    size_t length = 0;
+    while (length < rule.size() && std::isalpha(static_cast<unsigned char>(rule[length]))) length++;
+    rule.remove_prefix(length);
+    return length >= 3;
+}
+
+// One end of a daylight saving period: a day of the year and a wall time on it
+struct RuleDate {
+    char kind = 'M';
+    int month = 0;
+    int week = 0;
+    int weekday = 0;
+    int dayOfYear = 0;
+    int64_t time = 2 * 3600;
+};
+
+bool readRuleDate(std::string_view& rule, RuleDate& date) {
+    auto number = [&rule](int& value) {
+        if (rule.empty() || !std::isdigit(static_cast<unsigned char>(rule[0]))) return false;
+        value = 0;
+        while (!rule.empty() && std::isdigit(static_cast<unsigned char>(rule[0]))) {
+            value = value * 10 + (rule[0] - '0');
+            rule.remove_prefix(1);
+        }
+        return true;
+    };
+    if (rule.empty()) return false;
+    if (rule[0] == 'M') {
+        rule.remove_prefix(1);
+        if (!number(date.month) || rule.empty() || rule[0] != '.') return false;
+        rule.remove_prefix(1);
+        if (!number(date.week) || rule.empty() || rule[0] != '.') return false;
+        rule.remove_prefix(1);
+        if (!number(date.weekday)) return false;
+        if (date.month < 1 || date.month > 12 || date.week < 1 || date.week > 5 || date.weekday > 6) return false;
+    } else if (rule[0] == 'J') {
+        rule.remove_prefix(1);
+        date.kind = 'J';
+        if (!number(date.dayOfYear) || date.dayOfYear < 1 || date.dayOfYear > 365) return false;
+    } else {
+        date.kind = 'N';
+        if (!number(date.dayOfYear) || date.dayOfYear > 365) return false;
+    }
+    if (!rule.empty() && rule[0] == '/') {
+        rule.remove_prefix(1);
+        if (!readRuleTime(rule, date.time)) return false;
+    }
+    return true;
+}
+
+// Local seconds since the epoch at which a rule date falls in the given year
+int64_t ruleDateSeconds(const RuleDate& date, int year) {
+    int64_t days;
+    if (date.kind == 'J') {
+        days = daysFromCivil(year, 1, 1) + date.dayOfYear - 1 + (isLeapYear(year) && date.dayOfYear >= 60 ? 1 : 0);
+    } else if (date.kind == 'N') {
+        days = daysFromCivil(year, 1, 1) + date.dayOfYear;
+    } else {
+        CivilDate::YearMonth month = {year, date.month};
+        int64_t first = daysFromCivil(year, date.month, 1);
+        int day = 1 + (date.weekday - month.firstWeekday() + 7) % 7 + (date.week - 1) * 7;
+        int monthDays = month.days();
+        while (day > monthDays) day -= 7;
+        days = first + day - 1;
+    }
+    return days * 86400 + date.time;
+}
+
+}
+
+const TimeZone* TimeZone::find(std::string_view name) {
+    if (name.empty() || name.find("..") != std::string_view::npos || name[0] == '/') return nullptr;
+    {
+        Registry& zones = registry();
+        std::lock_guard<std::mutex> lock(zones.mutex);
+        auto it = zones.byName.find(name);
+        if (it != zones.byName.end()) return it->second.get();
+    }
+    const char* directory = std::getenv("TZDIR");
+    std::string path = std::string(directory && *directory ? directory : "/usr/share/zoneinfo") + "/" + std::string(name);
+    return load(std::string(name), path);
+}
+
+const TimeZone* TimeZone::byId(uint16_t id) {
+    Registry& zones = registry();
+    std::lock_guard<std::mutex> lock(zones.mutex);
+    return id == 0 || id > zones.byId.size() ? nullptr : zones.byId[id - 1];
+}
+
+const TimeZone& TimeZone::local() {
+    static const TimeZone* zone = [] {
+        const char* tz = std::getenv("TZ");
+        if (tz && *tz) {
+            const TimeZone* named = find(tz[0] == ':' ? tz + 1 : tz);
+            if (named) return named;
+        }
+        std::error_code error;
+        std::string target = fs::read_symlink("/etc/localtime", error).string();
+        size_t zoneinfo = target.find("zoneinfo/");
+        std::string name = zoneinfo == std::string::npos ? "localtime" : target.substr(zoneinfo + 9);
+        const TimeZone* system = load(name, "/etc/localtime");
+        if (system) return system;
+        return find("UTC");
+    }();
+    return *zone;
+}
+
+// Reads and caches a TZif file; "UTC" falls back to a fixed zone when the tzdb is missing
+const TimeZone* TimeZone::load(const std::string& name, const std::string& path) {
+    std::unique_ptr<TimeZone> zone(new TimeZone());
+    zone->zoneName = name;
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream contents;
+    if (file) contents << file.rdbuf();
+    if (!file || !zone->parseTzif(contents.str())) {
+        if (name != "UTC") return nullptr;
+        zone->transitions.clear();
+        zone->offsets.clear();
+        zone->initialOffset = 0;
+    }
+
+    Registry& zones = registry();
+    std::lock_guard<std::mutex> lock(zones.mutex);
+    auto it = zones.byName.find(name);
+    if (it != zones.byName.end()) return it->second.get();
+    if (zones.byId.size() >= UINT16_MAX) return nullptr;
+    zones.byId.push_back(zone.get());
+    zone->zoneId = static_cast<uint16_t>(zones.byId.size());
+    return zones.byName.emplace(name, std::move(zone)).first->second.get();
+}
+
+// RFC 8536: a v1 block with 32-bit times, then for version 2+ a second header and block with
+// 64-bit times followed by a POSIX TZ string for instants after the last transition
+bool TimeZone::parseTzif(const std::string& data) {
+    auto parseBlock = [&](size_t offset, size_t timeSize, size_t& end) {
+        if (data.size() < offset + 44 || data.compare(offset, 4, "TZif") != 0) return false;
+        int64_t isUtcCount = readBigEndian(data, offset + 20, 4);
+        int64_t isStdCount = readBigEndian(data, offset + 24, 4);
+        int64_t leapCount = readBigEndian(data, offset + 28, 4);
+        int64_t timeCount = readBigEndian(data, offset + 32, 4);
+        int64_t typeCount = readBigEndian(data, offset + 36, 4);
+        int64_t charCount = readBigEndian(data, offset + 40, 4);
+        if (typeCount < 1 || timeCount < 0) return false;
+        size_t times = offset + 44;
+        size_t indices = times + static_cast<size_t>(timeCount) * timeSize;
+        size_t types = indices + static_cast<size_t>(timeCount);
+        end = types + static_cast<size_t>(typeCount) * 6 + static_cast<size_t>(charCount)
+              + static_cast<size_t>(leapCount) * (timeSize + 4) + static_cast<size_t>(isStdCount + isUtcCount);
+        if (end > data.size()) return false;
+
+        std::vector<int32_t> typeOffsets;
+        for (int64_t i = 0; i < typeCount; i++) {
+            typeOffsets.push_back(static_cast<int32_t>(readBigEndian(data, types + static_cast<size_t>(i) * 6, 4)));
+        }
+        initialOffset = typeOffsets[0];
+        transitions.clear();
+        offsets.clear();
+        for (int64_t i = 0; i < timeCount; i++) {
+            size_t type = static_cast<uint8_t>(data[indices + static_cast<size_t>(i)]);
+            if (type >= typeOffsets.size()) return false;
+            transitions.push_back(readBigEndian(data, times + static_cast<size_t>(i) * timeSize, timeSize));
+            offsets.push_back(typeOffsets[type]);
+        }
+        return true;
+    };
+
+    size_t end = 0;
+    if (!parseBlock(0, 4, end)) return false;
+    if (data[4] < '2') return true;
+    if (!parseBlock(end, 8, end)) return false;
+    if (end < data.size() && data[end] == '\n') {
+        size_t close = data.find('\n', end + 1);
+        if (close != std::string::npos && close > end + 1) {
+            applyRule(std::string_view(data).substr(end + 1, close - end - 1));
+        }
+    }
+    return true;
+}
+
+// Expands a POSIX TZ string such as "EST5EDT,M3.2.0,M11.1.0" into transitions after the table
+bool TimeZone::applyRule(std::string_view rule) {
+    int64_t standard = 0;
+    if (!skipAbbreviation(rule) || !readRuleTime(rule, standard)) return false;
+    int32_t standardOffset = static_cast<int32_t>(-standard);
+    if (rule.empty()) {
+        if (transitions.empty()) initialOffset = standardOffset;
+        return true;
+    }
+
+    if (!skipAbbreviation(rule)) return false;
+    int32_t daylightOffset = standardOffset + 3600;
+    if (!rule.empty() && rule[0] != ',') {
+        int64_t daylight = 0;
+        if (!readRuleTime(rule, daylight)) return false;
+        daylightOffset = static_cast<int32_t>(-daylight);
+    }
+    RuleDate start, finish;
+    if (rule.empty() || rule[0] != ',') return false;
+    rule.remove_prefix(1);
+    if (!readRuleDate(rule, start) || rule.empty() || rule[0] != ',') return false;
+    rule.remove_prefix(1);
+    if (!readRuleDate(rule, finish)) return false;
+
+    int64_t last = transitions.empty() ? INT64_MIN : transitions.back();
+    int firstYear = 1970;
+    if (!transitions.empty()) firstYear = civilFromDays(floorDiv(last, 86400)).year;
+    std::vector<std::pair<int64_t, int32_t>> expanded;
+    for (int year = firstYear; year <= LAST_EXPANDED_YEAR; year++) {
+        // Daylight time starts at a standard wall time and ends at a daylight wall time
+        expanded.push_back({ruleDateSeconds(start, year) - standardOffset, daylightOffset});
+        expanded.push_back({ruleDateSeconds(finish, year) - daylightOffset, standardOffset});
+    }
+    std::sort(expanded.begin(), expanded.end());
+    for (const auto& transition : expanded) {
+        if (transition.first <= last) continue;
+        transitions.push_back(transition.first);
+        offsets.push_back(transition.second);
+    }
+    if (offsets.empty()) initialOffset = standardOffset;
+    return true;
+}
+
+int64_t TimeZone::toSeconds(const CivilTime& time) {
+    return daysFromCivil(time.year, time.month, time.day) * 86400 + time.hour * 3600 + time.minute * 60;
+}
+
+CivilTime TimeZone::toCivil(int64_t seconds) {
+    CivilTime time;
+    int64_t days = floorDiv(seconds, 86400);
+    int64_t secondOfDay = seconds - days * 86400;
+    CivilDate::Date date = civilFromDays(days);
+    time.year = date.year;
+    time.month = date.month;
+    time.day = date.day;
+    time.hour = static_cast<int>(secondOfDay / 3600);
+    time.minute = static_cast<int>(secondOfDay / 60 % 60);
+    return time;
+}
+
+bool TimeZone::parseWallTime(std::string_view text, int64_t& seconds) {
+    int fields[5] = {0, 0, 0, 0, 0};
+    size_t position = 0;
+    static const char SEPARATORS[] = {'-', '-', ' ', ':', '\0'};
+    for (int field = 0; field < 5; field++) {
+        size_t start = position;
+        while (position < text.size() && std::isdigit(static_cast<unsigned char>(text[position]))) {
+            fields[field] = fields[field] * 10 + (text[position] - '0');
+            position++;
+        }
+        if (field == 3 && position == start) break;
+        if (position == start || position - start > (field == 0 ? 4 : 2)) return false;
+        if (position == text.size()) {
+            // A date alone is midnight; a time needs both hours and minutes
+            if (field != 2 && field != 4) return false;
+            break;
+        }
+        if (field == 4 || (text[position] != SEPARATORS[field] && !(field == 2 && text[position] == 'T'))) {
+            // Anything after a complete date or time ends the wall time
+            if (field != 2 && field != 4) return false;
+            break;
+        }
+        position++;
+    }
+    CivilTime time = {fields[0], fields[1], fields[2], fields[3], fields[4]};
+    if (time.month < 1 || time.month > 12 || time.day < 1 || time.day > 31 || time.hour > 23 || time.minute > 59) return false;
+    seconds = toSeconds(time);
+    return true;
+}
+
+size_t TimeZone::formatWallTime(int64_t seconds, char separator, char* out) {
+    CivilTime time = toCivil(seconds);
+    int year = std::min(std::max(time.year, 0), 9999);
+    out[0] = static_cast<char>('0' + year / 1000);
+    out[1] = static_cast<char>('0' + year / 100 % 10);
+    out[2] = static_cast<char>('0' + year / 10 % 10);
+    out[3] = static_cast<char>('0' + year % 10);
+    out[4] = '-';
+    out[5] = static_cast<char>('0' + time.month / 10);
+    out[6] = static_cast<char>('0' + time.month % 10);
+    out[7] = '-';
+    out[8] = static_cast<char>('0' + time.day / 10);
+    out[9] = static_cast<char>('0' + time.day % 10);
+    out[10] = separator;
+    out[11] = static_cast<char>('0' + time.hour / 10);
+    out[12] = static_cast<char>('0' + time.hour % 10);
+    out[13] = ':';
+    out[14] = static_cast<char>('0' + time.minute / 10);
+    out[15] = static_cast<char>('0' + time.minute % 10);
+    return 16;
+}
+
+uint16_t TimeZone::id() const {
+    return zoneId;
+}
+
+const std::string& TimeZone::name() const {
+    return zoneName;
+}
+
+int TimeZone::offsetAt(int64_t utcSeconds) const {
+    auto it = std::upper_bound(transitions.begin(), transitions.end(), utcSeconds);
+    return it == transitions.begin() ? initialOffset : offsets[static_cast<size_t>(it - transitions.begin() - 1)];
+}
+
+int64_t TimeZone::toLocal(int64_t utcSeconds) const {
+    return utcSeconds + offsetAt(utcSeconds);
+}
+
+int64_t TimeZone::toUtc(int64_t localSeconds) const {
+    // The offsets a day either side bracket any single transition near this wall time
+    int before = offsetAt(localSeconds - 86400);
+    int after = offsetAt(localSeconds + 86400);
+    if (offsetAt(localSeconds - before) == before) return localSeconds - before;
+    if (offsetAt(localSeconds - after) == after) return localSeconds - after;
+    return localSeconds - before;
+}
+
+CivilTime TimeZone::now() const {
+    return toCivil(toLocal(static_cast<int64_t>(std::time(nullptr))));
+}